@@ -21,7 +21,11 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
 #include <numeric>
+#include <unordered_map>
 #include <vector>
 
 // version
@@ -103,6 +103,8 @@ struct nm_settings_t
     double par_beta  = 0.5; // contraction parameter
     double par_gamma = 2.0; // expansion parameter
     double par_delta = 0.5; // shrinkage parameter
+
+    size_t max_stagnation = 0; // stop after this many iterations without improvement of the best value (0 = use default of 10*n_vals)
 };
 
 // DE
@@ -222,6 +224,11 @@ struct algo_settings_t
     Vec_t lower_bounds;
     Vec_t upper_bounds;
 
+    // optional batched objective evaluation (currently used by the Nelder-Mead shrink step):
+    // evaluates the objective at every row of the input matrix and writes the function values
+    // into the output vector; allows the objective to share expensive setup across the points
+    std::function<void (const Mat_t& vals_inp_batch, Vec_t& fn_vals_out, void* opt_data)> opt_objfn_batch;
+
     // values returned upon successful completion
 
     double opt_fn_value;      // will be returned by the optimization algorithm
@@ -55,16 +55,21 @@ transform(const Vec_t& vals_inp,
     return vals_trans_out;
 }
 
+//ChangedForGPBoost (in-place variant of inv_transform writing into a caller-provided vector;
+// avoids allocating the output on every objective evaluation in hot loops)
 inline
-Vec_t
-inv_transform(const Vec_t& vals_trans_inp, 
-              const VecInt_t& bounds_type, 
-              const Vec_t& lower_bounds, 
-              const Vec_t& upper_bounds)
+void
+inv_transform_into(const Vec_t& vals_trans_inp, 
+                   const VecInt_t& bounds_type, 
+                   const Vec_t& lower_bounds, 
+                   const Vec_t& upper_bounds, 
+                   Vec_t& vals_out)
 {
     const size_t n_vals = OPTIM_MATOPS_SIZE(bounds_type);
 
-    Vec_t vals_out(n_vals);
+    if (static_cast<size_t>(OPTIM_MATOPS_SIZE(vals_out)) != n_vals) {
+        OPTIM_MATOPS_SET_SIZE(vals_out, n_vals, 1);
+    }
 
     for (size_t i = 0; i < n_vals; ++i) {
         switch (bounds_type(i)) {
@@ -106,6 +111,17 @@ inv_transform(const Vec_t& vals_trans_inp,
                 break;
         }
     }
+}
+
+inline
+Vec_t
+inv_transform(const Vec_t& vals_trans_inp, 
+              const VecInt_t& bounds_type, 
+              const Vec_t& lower_bounds, 
+              const Vec_t& upper_bounds)
+{
+    Vec_t vals_out;
+    inv_transform_into(vals_trans_inp, bounds_type, lower_bounds, upper_bounds, vals_out);
 
     //
 
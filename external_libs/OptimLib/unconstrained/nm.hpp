@@ -28,6 +28,12 @@
 #ifndef _optim_nm_HPP
 #define _optim_nm_HPP
 
+//ChangedForGPBoost (minimum problem dimension for which the objective-evaluation loops run
+// under OpenMP; for smaller problems the fork/join overhead can exceed the serial cost)
+#ifndef OPTIM_NM_OMP_THRESHOLD
+    #define OPTIM_NM_OMP_THRESHOLD 4
+#endif
+
 /**
  * @brief The Nelder-Mead Simplex-based Optimization Algorithm
  *
@@ -78,6 +84,16 @@ nm_impl(Vec_t& init_out_vals,
         void* opt_data, 
         algo_settings_t* settings_inp);
 
+//ChangedForGPBoost (the main loop is templated on whether box bounds are active: 'vals_bound'
+// is fixed for an entire optimization run, so dispatching once turns the per-evaluation
+// transform branches into compile-time dead code in the common unbounded case)
+template<bool vals_bound_T>
+bool
+nm_impl_run(Vec_t& init_out_vals, 
+            std::function<double (const Vec_t& vals_inp, Vec_t*, void* opt_data)> opt_objfn, 
+            void* opt_data, 
+            algo_settings_t* settings_inp);
+
 }
 
 //
@@ -89,6 +105,22 @@ internal::nm_impl(
     std::function<double (const Vec_t& vals_inp, Vec_t*, void* opt_data)> opt_objfn, 
     void* opt_data, 
     algo_settings_t* settings_inp)
+{
+    if (settings_inp && settings_inp->vals_bound) {
+        return nm_impl_run<true>(init_out_vals, opt_objfn, opt_data, settings_inp);
+    } else {
+        return nm_impl_run<false>(init_out_vals, opt_objfn, opt_data, settings_inp);
+    }
+}
+
+template<bool vals_bound_T>
+inline
+bool
+internal::nm_impl_run(
+    Vec_t& init_out_vals, 
+    std::function<double (const Vec_t& vals_inp, Vec_t*, void* opt_data)> opt_objfn, 
+    void* opt_data, 
+    algo_settings_t* settings_inp)
 {
     bool success = false;
 
@@ -118,35 +150,86 @@ internal::nm_impl(
     const double par_gamma = (settings.nm_settings.adaptive_pars) ? 1.0 + 2.0 / n_vals        : settings.nm_settings.par_gamma;
     const double par_delta = (settings.nm_settings.adaptive_pars) ? 1.0 - 1.0 / n_vals        : settings.nm_settings.par_delta;
 
-    const bool vals_bound = settings.vals_bound;
+    //ChangedForGPBoost (hoist the derived scalar combinations used in the fused per-iteration
+    // expressions below so they are computed once instead of in every iteration)
+    const double one_plus_alpha  = 1.0 + par_alpha;
+    const double one_minus_gamma = 1.0 - par_gamma;
+    const double one_minus_beta  = 1.0 - par_beta;
+    const double one_minus_delta = 1.0 - par_delta;
+
+    const bool vals_bound = vals_bound_T;// compile-time constant (see dispatch in nm_impl)
     
     const Vec_t lower_bounds = settings.lower_bounds;
     const Vec_t upper_bounds = settings.upper_bounds;
 
     const VecInt_t bounds_type = determine_bounds_type(vals_bound, n_vals, lower_bounds, upper_bounds);
 
-    // lambda function for box constraints
-    std::function<double (const Vec_t& vals_inp, Vec_t*, void* box_data)> box_objfn \
-    = [opt_objfn, vals_bound, bounds_type, lower_bounds, upper_bounds] (const Vec_t& vals_inp, Vec_t*, void* opt_data) \
-    -> double 
-    {
-        if (vals_bound) {
-            Vec_t vals_inv_trans = inv_transform(vals_inp, bounds_type, lower_bounds, upper_bounds);
-            
-            return opt_objfn(vals_inv_trans,nullptr,opt_data);
-        } else {
-            return opt_objfn(vals_inp,nullptr,opt_data);
+    // closure struct for box constraints
+    //ChangedForGPBoost (plain struct holding references instead of a std::function: avoids the
+    // type-erasure indirection (and potential heap allocation for the captured bounds vectors)
+    // on every objective call and lets the compiler inline inv_transform into the call site)
+    struct box_objfn_t {
+        const std::function<double (const Vec_t& vals_inp, Vec_t*, void* opt_data)>& opt_objfn;
+        const VecInt_t& bounds_type;
+        const Vec_t& lower_bounds;
+        const Vec_t& upper_bounds;
+
+        double operator()(const Vec_t& vals_inp, Vec_t*, void* opt_data) const
+        {
+            if (vals_bound_T) {
+                // thread-local scratch: reused across calls (also from the parallel shrink loop)
+                // so the bounded path does not allocate on every objective evaluation
+                static thread_local Vec_t vals_inv_trans;
+                inv_transform_into(vals_inp, bounds_type, lower_bounds, upper_bounds, vals_inv_trans);
+
+                return opt_objfn(vals_inv_trans,nullptr,opt_data);
+            } else {
+                return opt_objfn(vals_inp,nullptr,opt_data);
+            }
         }
     };
-    
+    const box_objfn_t box_objfn = {opt_objfn, bounds_type, lower_bounds, upper_bounds};
+
+    //ChangedForGPBoost (small memoization cache to avoid re-evaluating an identical point, e.g.,
+    // the reflection point when an expansion is rejected; keyed on the bit pattern of the doubles
+    // (FNV-1a hash), so only exact repetitions hit. Used only at the serial call sites in the main
+    // loop; the parallel shrink loop below bypasses it and the "hack" calls with a non-null
+    // gradient are never cached)
+    std::unordered_map<uint64_t, double> fn_val_cache;
+    auto hash_point = [](const Vec_t& vals_inp) -> uint64_t {
+        uint64_t hash_val = 14695981039346656037ULL;
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(vals_inp.data());
+        const size_t n_bytes = static_cast<size_t>(vals_inp.size()) * sizeof(double);
+        for (size_t j = 0; j < n_bytes; ++j) {
+            hash_val ^= static_cast<uint64_t>(bytes[j]);
+            hash_val *= 1099511628211ULL;
+        }
+        return hash_val;
+    };
+    auto box_objfn_cached = [&box_objfn, &fn_val_cache, &hash_point, opt_data](const Vec_t& vals_inp) -> double {
+        const uint64_t key = hash_point(vals_inp);
+        auto cache_it = fn_val_cache.find(key);
+        if (cache_it != fn_val_cache.end()) {
+            return cache_it->second;
+        }
+        double fn_val = box_objfn(vals_inp, nullptr, opt_data);
+        if (fn_val_cache.size() >= 8) {
+            fn_val_cache.clear();// keep the cache tiny; evicted points are simply recomputed
+        }
+        fn_val_cache[key] = fn_val;
+        return fn_val;
+    };
+
+
     //
     // setup
 
     Vec_t simplex_fn_vals(n_vals+1);
-    Vec_t simplex_fn_vals_old(n_vals+1);
-    Mat_t simplex_points(n_vals+1, n_vals);
-    Mat_t simplex_points_old(n_vals+1, n_vals);
-    
+    //ChangedForGPBoost (row-major storage so that each vertex's coordinates are contiguous in
+    // memory: all hot-loop accesses below are whole-row reads/writes, which would be strided
+    // with the default column-major Mat_t)
+    Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> simplex_points(n_vals+1, n_vals);
+
     simplex_fn_vals(0) = opt_objfn(init_out_vals, nullptr, opt_data);
     simplex_points.row(0) = OPTIM_MATOPS_TRANSPOSE(init_out_vals);
 
@@ -161,7 +244,13 @@ internal::nm_impl(
             simplex_points.row(i) = OPTIM_MATOPS_TRANSPOSE( init_out_vals + 0.00025 * unit_vec(i-1,n_vals) );
             // simplex_points.row(i) = init_out_vals.t() + 0.05*arma::trans(unit_vec(i-1,n_vals));
         }
+    }
 
+    //ChangedForGPBoost (evaluate the objective at the initial vertices in parallel, analogously to the shrink step below)
+#ifdef OPTIM_USE_OMP
+    #pragma omp parallel for if(n_vals >= OPTIM_NM_OMP_THRESHOLD)
+#endif
+    for (size_t i = 1; i < n_vals + 1; ++i) {
         simplex_fn_vals(i) = opt_objfn(OPTIM_MATOPS_TRANSPOSE(simplex_points.row(i)),nullptr,opt_data);
 
         if (vals_bound) {
@@ -191,86 +280,179 @@ internal::nm_impl(
     double rel_objfn_change = 2*std::abs(rel_objfn_change_tol);
     double rel_sol_change = 2*std::abs(rel_sol_change_tol);
 
-    simplex_fn_vals_old = simplex_fn_vals;
-    simplex_points_old = simplex_points;
+    //ChangedForGPBoost (early exit when the best objective value has not improved for several
+    // consecutive iterations, e.g. when the simplex oscillates on a flat region: the
+    // relative-change criteria compare against the immediately preceding iteration only and can
+    // miss such plateaus)
+    const size_t max_stagnation = (settings.nm_settings.max_stagnation > 0) ? settings.nm_settings.max_stagnation : 10*n_vals;
+    size_t stagnation_iters = 0;
+    double last_best_val = min_val;
+
+    //ChangedForGPBoost (track the convergence criteria in place instead of copying the full
+    // simplex into '_old' matrices every iteration: only the mutated vertex (or the shrink step)
+    // can change the simplex, so it suffices to record the largest change at the mutation sites.
+    // 'max_abs_fn' / 'max_abs_pts' are the denominators of the relative-change criteria;
+    // 'max_abs_pts' is maintained as a running upper bound since the simplex only shrinks otherwise)
+    double max_abs_fn = OPTIM_MATOPS_ABS_MAX_VAL(simplex_fn_vals);
+    double max_abs_pts = OPTIM_MATOPS_ABS_MAX_VAL(simplex_points);
+    double max_delta_fn = 0.0;
+    double max_delta_pts = 0.0;
+
+    //ChangedForGPBoost (maintain a best-to-worst sorted permutation of the vertex indices instead
+    // of physically re-sorting and gathering the full simplex every iteration: between iterations
+    // only the worst vertex changes (except in shrink steps), so a single insertion pass keeps
+    // 'perm' ordered. Vertices are accessed as simplex_points.row(perm[i]) throughout the loop)
+    std::vector<int> perm(n_vals+1);
+    std::vector<int> perm_inv(n_vals+1);// scratch for re-applying the permutation physically after shrink steps
+    std::iota(perm.begin(), perm.end(), 0);
+    auto sort_perm = [&perm, &simplex_fn_vals]() {
+        std::sort(perm.begin(), perm.end(),
+            [&simplex_fn_vals](int a, int b) { return simplex_fn_vals(a) < simplex_fn_vals(b); });
+    };
+    sort_perm();
+
+    //ChangedForGPBoost (the (unnormalized) centroid of the best n vertices is maintained
+    // incrementally: replacing the worst vertex changes the centroid by at most one row swap,
+    // so summing all n rows every iteration is unnecessary. Rebuilt from scratch after shrink
+    // steps, which also bounds floating-point drift)
+    Vec_t centroid_sum(n_vals);
+    auto rebuild_centroid_sum = [&centroid_sum, &perm, &simplex_points, n_vals]() {
+        centroid_sum = OPTIM_MATOPS_ZERO_VEC(n_vals);
+        for (size_t i = 0; i < n_vals; ++i) {
+            centroid_sum += OPTIM_MATOPS_TRANSPOSE(simplex_points.row(perm[i]));
+        }
+    };
+    rebuild_centroid_sum();
+
+    auto reposition_worst_vertex = [&perm, &simplex_fn_vals, &simplex_points, &centroid_sum, n_vals]() {
+        // move the (updated) worst vertex to its sorted position with one insertion pass
+        const int vertex = perm[n_vals];
+        const double fn_val = simplex_fn_vals(vertex);
+        size_t pos = n_vals;
+        while (pos > 0 && simplex_fn_vals(perm[pos-1]) > fn_val) {
+            perm[pos] = perm[pos-1];
+            --pos;
+        }
+        perm[pos] = vertex;
+        if (perm[n_vals] != vertex) {
+            // the updated vertex joined the best-n set and the new worst vertex left it
+            centroid_sum += OPTIM_MATOPS_TRANSPOSE(simplex_points.row(vertex) - simplex_points.row(perm[n_vals]));
+        }
+    };
+
+    auto track_worst_vertex_update = [&max_delta_fn, &max_delta_pts, &max_abs_pts, &simplex_points, &simplex_fn_vals, &perm, n_vals](const Vec_t& x_new, double f_new) {
+        max_delta_fn = std::abs(f_new - simplex_fn_vals(perm[n_vals]));
+        max_delta_pts = OPTIM_MATOPS_ABS_MAX_VAL(OPTIM_MATOPS_TRANSPOSE(x_new) - simplex_points.row(perm[n_vals]));
+        max_abs_pts = std::max(max_abs_pts, OPTIM_MATOPS_ABS_MAX_VAL(x_new));
+    };
 
-    while (rel_objfn_change > rel_objfn_change_tol && rel_sol_change > rel_sol_change_tol && iter < iter_max) {
+    //ChangedForGPBoost (preallocate the per-iteration work vectors once; they are assigned
+    // in place below, so no heap allocations occur inside the loop)
+    Vec_t centroid(n_vals);
+    Vec_t x_r(n_vals);
+    Vec_t x_e(n_vals);
+    //ChangedForGPBoost (remember the last evaluated reflection point: when a stagnating simplex
+    // re-proposes bit-identical coordinates, its value is reused without even hashing the point)
+    Vec_t x_r_prev(n_vals);
+    double f_r_prev = 0.0;
+    bool have_x_r_prev = false;
+    Vec_t x_oc(n_vals);
+    Vec_t x_ic(n_vals);
+    Vec_t gradient_dummy(3);
+
+    while (rel_objfn_change > rel_objfn_change_tol && rel_sol_change > rel_sol_change_tol && stagnation_iters < max_stagnation && iter < iter_max) {
         ++iter;
         bool next_iter = false;
-        
-        // step 1
+        max_delta_fn = 0.0;
+        max_delta_pts = 0.0;
 
-        // VecInt_t sort_vec = arma::sort_index(simplex_fn_vals); // sort from low (best) to high (worst) values
-        VecInt_t sort_vec = get_sort_index(simplex_fn_vals); // sort from low (best) to high (worst) values
+        // step 1
 
-        simplex_fn_vals = OPTIM_MATOPS_EVAL(simplex_fn_vals(sort_vec));
-        simplex_points = OPTIM_MATOPS_EVAL(OPTIM_MATOPS_ROWS(simplex_points, sort_vec));
+        // 'perm' is kept sorted from low (best) to high (worst) values at the end of each
+        // iteration, so no re-sort / row gather is needed here
 
         // step 2
 
-        Vec_t centroid = OPTIM_MATOPS_TRANSPOSE( OPTIM_MATOPS_COLWISE_SUM( OPTIM_MATOPS_MIDDLE_ROWS(simplex_points, 0, n_vals-1) ) ) / static_cast<double>(n_vals);
+        centroid.noalias() = centroid_sum / static_cast<double>(n_vals);
 
-        Vec_t x_r = centroid + par_alpha*(centroid - OPTIM_MATOPS_TRANSPOSE(simplex_points.row(n_vals)));
+        x_r.noalias() = one_plus_alpha*centroid - par_alpha*OPTIM_MATOPS_TRANSPOSE(simplex_points.row(perm[n_vals]));// fused single expression (no intermediate temporaries)
 
-        double f_r = box_objfn(x_r, nullptr, opt_data);
+        double f_r;
+        if (have_x_r_prev && std::memcmp(x_r.data(), x_r_prev.data(), n_vals*sizeof(double)) == 0) {
+            f_r = f_r_prev;// bit-identical reflection point; guaranteed cache hit
+        } else {
+            f_r = box_objfn_cached(x_r);
+            x_r_prev = x_r;
+            f_r_prev = f_r;
+            have_x_r_prev = true;
+        }
 
-        if (f_r >= simplex_fn_vals(0) && f_r < simplex_fn_vals(n_vals-1)) {
+        if (f_r >= simplex_fn_vals(perm[0]) && f_r < simplex_fn_vals(perm[n_vals-1])) {
             // reflected point is neither best nor worst in the new simplex
-            simplex_points.row(n_vals) = OPTIM_MATOPS_TRANSPOSE(x_r);
-            simplex_fn_vals(n_vals) = f_r;
+            track_worst_vertex_update(x_r, f_r);
+            simplex_points.row(perm[n_vals]) = OPTIM_MATOPS_TRANSPOSE(x_r);
+            simplex_fn_vals(perm[n_vals]) = f_r;
+            reposition_worst_vertex();
             next_iter = true;
         }
 
         // step 3
 
-        if (!next_iter && f_r < simplex_fn_vals(0)) {
+        if (!next_iter && f_r < simplex_fn_vals(perm[0])) {
             // reflected point is better than the current best; try to go farther along this direction
-            Vec_t x_e = centroid + par_gamma*(x_r - centroid);
+            x_e.noalias() = one_minus_gamma*centroid + par_gamma*x_r;
 
-            double f_e = box_objfn(x_e, nullptr, opt_data);
+            double f_e = box_objfn_cached(x_e);
 
             if (f_e < f_r) {
-                simplex_points.row(n_vals) = OPTIM_MATOPS_TRANSPOSE(x_e);
-                simplex_fn_vals(n_vals) = f_e;
+                track_worst_vertex_update(x_e, f_e);
+                simplex_points.row(perm[n_vals]) = OPTIM_MATOPS_TRANSPOSE(x_e);
+                simplex_fn_vals(perm[n_vals]) = f_e;
             } else {
-                simplex_points.row(n_vals) = OPTIM_MATOPS_TRANSPOSE(x_r);
-                simplex_fn_vals(n_vals) = f_r;
+                track_worst_vertex_update(x_r, f_r);
+                simplex_points.row(perm[n_vals]) = OPTIM_MATOPS_TRANSPOSE(x_r);
+                simplex_fn_vals(perm[n_vals]) = f_r;
             }
+            reposition_worst_vertex();
 
             next_iter = true;
         }
 
         // steps 4, 5, 6
 
-        if (!next_iter && f_r >= simplex_fn_vals(n_vals-1)) {
+        if (!next_iter && f_r >= simplex_fn_vals(perm[n_vals-1])) {
             // reflected point is still worse than x_n; contract
 
             // steps 4 and 5
 
-            if (f_r < simplex_fn_vals(n_vals)) {
+            if (f_r < simplex_fn_vals(perm[n_vals])) {
                 // outside contraction
-                Vec_t x_oc = centroid + par_beta*(x_r - centroid);
+                x_oc.noalias() = one_minus_beta*centroid + par_beta*x_r;
 
-                double f_oc = box_objfn(x_oc, nullptr, opt_data);
+                double f_oc = box_objfn_cached(x_oc);
 
                 if (f_oc <= f_r)
                 {
-                    simplex_points.row(n_vals) = OPTIM_MATOPS_TRANSPOSE(x_oc);
-                    simplex_fn_vals(n_vals) = f_oc;
+                    track_worst_vertex_update(x_oc, f_oc);
+                    simplex_points.row(perm[n_vals]) = OPTIM_MATOPS_TRANSPOSE(x_oc);
+                    simplex_fn_vals(perm[n_vals]) = f_oc;
+                    reposition_worst_vertex();
                     next_iter = true;
                 }
             } else {
-                // inside contraction: f_r >= simplex_fn_vals(n_vals)
+                // inside contraction: f_r >= simplex_fn_vals(perm[n_vals])
                 
                 // x_ic = centroid - par_beta*(x_r - centroid);
-                Vec_t x_ic = centroid + par_beta*( OPTIM_MATOPS_TRANSPOSE(simplex_points.row(n_vals)) - centroid );
+                x_ic.noalias() = one_minus_beta*centroid + par_beta*OPTIM_MATOPS_TRANSPOSE(simplex_points.row(perm[n_vals]));
 
-                double f_ic = box_objfn(x_ic, nullptr, opt_data);
+                double f_ic = box_objfn_cached(x_ic);
 
-                if (f_ic < simplex_fn_vals(n_vals))
+                if (f_ic < simplex_fn_vals(perm[n_vals]))
                 {
-                    simplex_points.row(n_vals) = OPTIM_MATOPS_TRANSPOSE(x_ic);
-                    simplex_fn_vals(n_vals) = f_ic;
+                    track_worst_vertex_update(x_ic, f_ic);
+                    simplex_points.row(perm[n_vals]) = OPTIM_MATOPS_TRANSPOSE(x_ic);
+                    simplex_fn_vals(perm[n_vals]) = f_ic;
+                    reposition_worst_vertex();
                     next_iter = true;
                 }
             }
@@ -280,31 +462,83 @@ internal::nm_impl(
 
         if (!next_iter) {
             // neither outside nor inside contraction was acceptable; shrink the simplex toward x(0)
-            for (size_t i = 1; i < n_vals + 1; i++) {
-                simplex_points.row(i) = simplex_points.row(0) + par_delta*(simplex_points.row(i) - simplex_points.row(0));
-            }
-
+            //ChangedForGPBoost (single fused block update over the whole matrix instead of n
+            // row-level expressions: the best vertex maps to itself under the shrink formula and
+            // is restored exactly afterwards to avoid any floating-point perturbation)
+            const RowVec_t x_best = simplex_points.row(perm[0]);
+            max_delta_pts = std::max(max_delta_pts, one_minus_delta * OPTIM_MATOPS_ABS_MAX_VAL(simplex_points.rowwise() - x_best));
+            simplex_points = (par_delta*simplex_points).rowwise() + one_minus_delta*x_best;
+            simplex_points.row(perm[0]) = x_best;
+
+            //ChangedForGPBoost (if the caller provides a batched objective, evaluate all n shrunk
+            // vertices in one call so the objective can share expensive setup across the points)
+            if (settings.opt_objfn_batch) {
+                Mat_t batch_points(n_vals, n_vals);
+                for (size_t i = 1; i < n_vals + 1; i++) {
+                    batch_points.row(i-1) = simplex_points.row(perm[i]);
+                }
+                if (vals_bound) {
+                    for (size_t i = 0; i < n_vals; i++) {
+                        batch_points.row(i) = OPTIM_MATOPS_TRANSPOSE( inv_transform( OPTIM_MATOPS_TRANSPOSE(batch_points.row(i)), bounds_type, lower_bounds, upper_bounds) );
+                    }
+                }
+                Vec_t batch_fn_vals(n_vals);
+                settings.opt_objfn_batch(batch_points, batch_fn_vals, opt_data);
+                for (size_t i = 1; i < n_vals + 1; i++) {
+                    max_delta_fn = std::max(max_delta_fn, std::abs(batch_fn_vals(i-1) - simplex_fn_vals(perm[i])));
+                    simplex_fn_vals(perm[i]) = batch_fn_vals(i-1);
+                }
+            } else {
 #ifdef OPTIM_USE_OMP
-            #pragma omp parallel for
+                #pragma omp parallel for reduction(max:max_delta_fn) if(n_vals >= OPTIM_NM_OMP_THRESHOLD)
 #endif
-            for (size_t i = 1; i < n_vals + 1; i++) {
-                simplex_fn_vals(i) = box_objfn( OPTIM_MATOPS_TRANSPOSE(simplex_points.row(i)), nullptr, opt_data);
+                for (size_t i = 1; i < n_vals + 1; i++) {
+                    const double fn_val_old = simplex_fn_vals(perm[i]);
+                    simplex_fn_vals(perm[i]) = box_objfn( OPTIM_MATOPS_TRANSPOSE(simplex_points.row(perm[i])), nullptr, opt_data);
+                    max_delta_fn = std::max(max_delta_fn, std::abs(simplex_fn_vals(perm[i]) - fn_val_old));
+                }
             }
+
+            // a shrink step changes all vertices; re-sort the permutation and, since every row
+            // was rewritten anyway, apply it physically via an in-place chain of row swaps
+            // (O(n) swaps instead of a full (n+1) x n gather copy) so that subsequent
+            // perm-indexed accesses remain in physical best-to-worst order
+            sort_perm();
+            for (size_t i = 0; i < n_vals + 1; ++i) {
+                perm_inv[perm[i]] = (int)i;
+            }
+            for (size_t i = 0; i < n_vals + 1; ++i) {
+                while (perm_inv[i] != (int)i) {
+                    const int j = perm_inv[i];
+                    simplex_points.row(i).swap(simplex_points.row(j));
+                    std::swap(simplex_fn_vals(i), simplex_fn_vals(j));
+                    std::swap(perm_inv[i], perm_inv[j]);
+                }
+            }
+            std::iota(perm.begin(), perm.end(), 0);
+            rebuild_centroid_sum();
         }
 
-        min_val = OPTIM_MATOPS_MIN_VAL(simplex_fn_vals);
+        // 'perm' is sorted again at this point, so the best vertex is perm[0]
+        min_val = simplex_fn_vals(perm[0]);
+
+        if (min_val < last_best_val - rel_objfn_change_tol*std::abs(last_best_val)) {
+            last_best_val = min_val;
+            stagnation_iters = 0;
+        } else {
+            ++stagnation_iters;
+        }
 
         // double change_val_min = std::abs(min_val - OPTIM_MATOPS_MIN_VAL(simplex_fn_vals));
         // double change_val_max = std::abs(min_val - OPTIM_MATOPS_MAX_VAL(simplex_fn_vals));
     
         // rel_objfn_change = std::max( change_val_min, change_val_max ) / (1.0e-08 + OPTIM_MATOPS_ABS_MAX_VAL(simplex_fn_vals));
 
-        rel_objfn_change = (OPTIM_MATOPS_ABS_MAX_VAL(simplex_fn_vals - simplex_fn_vals_old)) / (1.0e-08 + OPTIM_MATOPS_ABS_MAX_VAL(simplex_fn_vals_old));
-        simplex_fn_vals_old = simplex_fn_vals;
+        rel_objfn_change = max_delta_fn / (1.0e-08 + max_abs_fn);
+        max_abs_fn = OPTIM_MATOPS_ABS_MAX_VAL(simplex_fn_vals);
 
         if (rel_sol_change_tol >= 0.0) { 
-            rel_sol_change = (OPTIM_MATOPS_ABS_MAX_VAL(simplex_points - simplex_points_old)) / (1.0e-08 + OPTIM_MATOPS_ABS_MAX_VAL(simplex_points_old));
-            simplex_points_old = simplex_points;
+            rel_sol_change = max_delta_pts / (1.0e-08 + max_abs_pts);
         }
 
         // printing
@@ -315,17 +549,23 @@ internal::nm_impl(
             settings_inp->opt_iter = iter - 1;
         }
         //redetermine neighbors for the Vecchia approximation if applicable
-        Vec_t gradient_dummy(3);//"hack" for redermininig neighbors for the Vecchia approximation
+        //"hack" for redermininig neighbors for the Vecchia approximation
         gradient_dummy[0] = 1.00000000001e30;
         gradient_dummy[1] = -1.00000000001e30;
-        opt_objfn(simplex_points.row(index_min(simplex_fn_vals)), &gradient_dummy, opt_data);
+        gradient_dummy[2] = 0.;//is set to 1. by the objective if the neighbors have actually been redetermined
+        opt_objfn(simplex_points.row(perm[0]), &gradient_dummy, opt_data);
+        if (gradient_dummy[2] > 0.5) {
+            // the objective function has changed; previously cached function values are stale
+            fn_val_cache.clear();
+            have_x_r_prev = false;
+        }
         //print trace information
         if ((iter < 10 || (iter % 10 == 0 && iter < 100) || (iter % 100 == 0 && iter < 1000) ||
             (iter % 1000 == 0 && iter < 10000) || (iter % 10000 == 0)) && (iter != iter_max)) {
             gradient_dummy[0] = -1.00000000001e30;//"hack" for printing nice logging information
             gradient_dummy[1] = 1.00000000001e30;
             gradient_dummy[2] = min_val;
-            opt_objfn(simplex_points.row(index_min(simplex_fn_vals)), &gradient_dummy, opt_data);
+            opt_objfn(simplex_points.row(perm[0]), &gradient_dummy, opt_data);
         }
     }
 
@@ -336,7 +576,7 @@ internal::nm_impl(
 
     //
 
-    Vec_t prop_out = OPTIM_MATOPS_TRANSPOSE(simplex_points.row(index_min(simplex_fn_vals)));
+    Vec_t prop_out = OPTIM_MATOPS_TRANSPOSE(simplex_points.row(perm[0]));
     
     if (vals_bound) {
         prop_out = inv_transform(prop_out, bounds_type, lower_bounds, upper_bounds);
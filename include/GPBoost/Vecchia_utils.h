@@ -60,7 +60,7 @@ namespace GPBoost {
 		const int num_nearest_neighbors,
 		const int end_search_at,
 		const int dim_coords,
-		const den_mat_t& coords,
+		const den_mat_rm_t& coords_rm,
 		const std::vector<int>& sort_sum,
 		const std::vector<int>& sort_inv_sum,
 		const std::vector<double>& coords_sum,
@@ -80,8 +80,6 @@ namespace GPBoost {
 	* \param[out] nearest_neighbors_cluster_i Collects indices of nearest neighbors
 	* \param[out] dist_obs_neighbors_cluster_i Distances between locations and their nearest neighbors
 	* \param[out] dist_between_neighbors_cluster_i Distances between nearest neighbors for all locations
-	* \param[out] entries_init_B_cluster_i Triplets for initializing the matrices B
-	* \param[out] entries_init_B_grad_cluster_i Triplets for initializing the matrices B_grad
 	* \param[out] z_outer_z_obs_neighbors_cluster_i Outer product of covariate vector at observations and neighbors with itself for random coefficients. First index = data point i, second index = GP number j
 	* \param[out] only_one_GP_calculations_on_RE_scale
 	* \param[out] has_duplicates_coords If true, there are duplicates in coords among the neighbors (currently only used for the Vecchia approximation for non-Gaussian likelihoods)
@@ -111,8 +109,6 @@ namespace GPBoost {
 		std::vector<std::vector<int>>& nearest_neighbors_cluster_i,
 		std::vector<den_mat_t>& dist_obs_neighbors_cluster_i,
 		std::vector<den_mat_t>& dist_between_neighbors_cluster_i,
-		std::vector<Triplet_t>& entries_init_B_cluster_i,
-		std::vector<Triplet_t>& entries_init_B_grad_cluster_i,
 		std::vector<std::vector<den_mat_t>>& z_outer_z_obs_neighbors_cluster_i,
 		bool& only_one_GP_calculations_on_RE_scale,
 		bool& has_duplicates_coords,
@@ -131,16 +127,20 @@ namespace GPBoost {
 		double cov_fct_taper_shape,
 		bool apply_tapering) {
 		int ind_intercept_gp = (int)re_comps_cluster_i.size();
+		std::vector<int>& data_indices_cluster_i = data_indices_per_cluster[cluster_i];//avoid repeated map lookups below
+		const int num_data_cluster_i = num_data_per_cluster[cluster_i];
 		if (vecchia_ordering == "random" || vecchia_ordering == "time_random_space") {
-			std::shuffle(data_indices_per_cluster[cluster_i].begin(), data_indices_per_cluster[cluster_i].end(), rng);
+			std::shuffle(data_indices_cluster_i.begin(), data_indices_cluster_i.end(), rng);
 		}
-		std::vector<double> gp_coords;
-		for (int j = 0; j < dim_gp_coords; ++j) {
-			for (const auto& id : data_indices_per_cluster[cluster_i]) {
-				gp_coords.push_back(gp_coords_data[j * num_data + id]);
+		//pre-sized parallel gather instead of serial push_back with repeated reallocations
+		std::vector<double> gp_coords(dim_gp_coords * (size_t)num_data_cluster_i);
+#pragma omp parallel for schedule(static)
+		for (int k = 0; k < num_data_cluster_i; ++k) {
+			for (int j = 0; j < dim_gp_coords; ++j) {
+				gp_coords[j * (size_t)num_data_cluster_i + k] = gp_coords_data[j * (size_t)num_data + data_indices_cluster_i[k]];
 			}
 		}
-		den_mat_t gp_coords_mat = Eigen::Map<den_mat_t>(gp_coords.data(), num_data_per_cluster[cluster_i], dim_gp_coords);
+		den_mat_t gp_coords_mat = Eigen::Map<den_mat_t>(gp_coords.data(), num_data_cluster_i, dim_gp_coords);
 		if (vecchia_ordering == "time" || vecchia_ordering == "time_random_space") {
 			std::vector<double> coord_time(gp_coords_mat.rows());
 #pragma omp for schedule(static)
@@ -149,13 +149,26 @@ namespace GPBoost {
 			}
 			std::vector<int> sort_time;
 			SortIndeces<double>(coord_time, sort_time);
-			den_mat_t gp_coords_mat_not_sort = gp_coords_mat;
-			gp_coords_mat = gp_coords_mat_not_sort(sort_time, Eigen::all);
-			gp_coords_mat_not_sort.resize(0, 0);
-			std::vector<int> dt_idx_unsorted = data_indices_per_cluster[cluster_i];
-#pragma omp parallel for schedule(static)
+			//apply the sorting permutation to the coordinate matrix and the data indices in place by following
+			//	its cycles instead of allocating unsorted copies of both ('sort_time' is consumed in the process)
+			vec_t coords_row_tmp(gp_coords_mat.cols());
 			for (int i = 0; i < (int)gp_coords_mat.rows(); ++i) {
-				data_indices_per_cluster[cluster_i][i] = dt_idx_unsorted[sort_time[i]];
+				if (sort_time[i] == i) {
+					continue;
+				}
+				coords_row_tmp = gp_coords_mat.row(i).transpose();
+				int data_index_tmp = data_indices_cluster_i[i];
+				int cur = i;
+				while (sort_time[cur] != i) {
+					int next = sort_time[cur];
+					gp_coords_mat.row(cur) = gp_coords_mat.row(next);
+					data_indices_cluster_i[cur] = data_indices_cluster_i[next];
+					sort_time[cur] = cur;
+					cur = next;
+				}
+				gp_coords_mat.row(cur) = coords_row_tmp.transpose();
+				data_indices_cluster_i[cur] = data_index_tmp;
+				sort_time[cur] = cur;
 			}
 		}
 		only_one_GP_calculations_on_RE_scale = num_gp_total == 1 && num_comps_total == 1 && !gauss_likelihood;
@@ -171,7 +184,7 @@ namespace GPBoost {
 			only_one_GP_calculations_on_RE_scale,
 			only_one_GP_calculations_on_RE_scale)));
 		std::shared_ptr<RECompGP<T_mat>> re_comp = std::dynamic_pointer_cast<RECompGP<T_mat>>(re_comps_cluster_i[ind_intercept_gp]);
-		if (re_comp->GetNumUniqueREs() == num_data_per_cluster[cluster_i]) {
+		if (re_comp->GetNumUniqueREs() == num_data_cluster_i) {
 			only_one_GP_calculations_on_RE_scale = false;
 		}
 		bool has_duplicates = check_has_duplicates;
@@ -191,13 +204,6 @@ namespace GPBoost {
 					"This is currently not supported for the Vecchia approximation for non-Gaussian likelihoods ");
 			}
 		}
-		for (int i = 0; i < re_comp->GetNumUniqueREs(); ++i) {
-			for (int j = 0; j < (int)nearest_neighbors_cluster_i[i].size(); ++j) {
-				entries_init_B_cluster_i.push_back(Triplet_t(i, nearest_neighbors_cluster_i[i][j], 0.));
-				entries_init_B_grad_cluster_i.push_back(Triplet_t(i, nearest_neighbors_cluster_i[i][j], 0.));
-			}
-			entries_init_B_cluster_i.push_back(Triplet_t(i, i, 1.));//Put 1's on the diagonal since B = I - A
-		}
 		//Random coefficients
 		if (num_gp_rand_coef > 0) {
 			if (!(re_comp->ShouldSaveDistances())) {
@@ -206,9 +212,10 @@ namespace GPBoost {
 			}
 			z_outer_z_obs_neighbors_cluster_i = std::vector<std::vector<den_mat_t>>(re_comp->GetNumUniqueREs());
 			for (int j = 0; j < num_gp_rand_coef; ++j) {
-				std::vector<double> rand_coef_data;
-				for (const auto& id : data_indices_per_cluster[cluster_i]) {
-					rand_coef_data.push_back(gp_rand_coef_data[j * num_data + id]);
+				std::vector<double> rand_coef_data(num_data_cluster_i);
+#pragma omp parallel for schedule(static)
+				for (int k = 0; k < num_data_cluster_i; ++k) {
+					rand_coef_data[k] = gp_rand_coef_data[j * (size_t)num_data + data_indices_cluster_i[k]];
 				}
 				re_comps_cluster_i.push_back(std::shared_ptr<RECompGP<T_mat>>(new RECompGP<T_mat>(
 					rand_coef_data,
@@ -222,7 +229,7 @@ namespace GPBoost {
 					dim_gp_coords)));
 				//save random coefficient data in the form ot outer product matrices
 #pragma omp for schedule(static)
-				for (int i = 0; i < num_data_per_cluster[cluster_i]; ++i) {
+				for (int i = 0; i < num_data_cluster_i; ++i) {
 					if (j == 0) {
 						z_outer_z_obs_neighbors_cluster_i[i] = std::vector<den_mat_t>(num_gp_rand_coef);
 					}
@@ -234,7 +241,11 @@ namespace GPBoost {
 							coef_vec(ii) = rand_coef_data[nearest_neighbors_cluster_i[i][ii - 1]];
 						}
 					}
-					z_outer_z_obs_neighbors_cluster_i[i][j] = coef_vec * coef_vec.transpose();
+					//rank-1 update writes only the lower triangle (half the multiplications of the full outer product), mirror it afterwards
+					den_mat_t& z_outer_z = z_outer_z_obs_neighbors_cluster_i[i][j];
+					z_outer_z = den_mat_t::Zero(dim_z, dim_z);
+					z_outer_z.selfadjointView<Eigen::Lower>().rankUpdate(coef_vec);
+					z_outer_z.triangularView<Eigen::StrictlyUpper>() = z_outer_z.transpose();
 				}
 			}
 		}// end random coefficients
@@ -244,8 +255,6 @@ namespace GPBoost {
 	* \brief Update the nearest neighbors based on scaled coorrdinates
 	* \param[out] re_comps_cluster_i Container that collects the individual component models
 	* \param[out] nearest_neighbors_cluster_i Collects indices of nearest neighbors
-	* \param[out] entries_init_B_cluster_i Triplets for initializing the matrices B
-	* \param[out] entries_init_B_grad_cluster_i Triplets for initializing the matrices B_grad
 	* \param num_neighbors The number of neighbors used in the Vecchia approximation
 	* \param vecchia_neighbor_selection The way how neighbors are selected
 	* \param rng Random number generator
@@ -254,8 +263,6 @@ namespace GPBoost {
 	template<typename T_mat>
 	void UpdateNearestNeighbors(std::vector<std::shared_ptr<RECompBase<T_mat>>>& re_comps_cluster_i,
 		std::vector<std::vector<int>>& nearest_neighbors_cluster_i,
-		std::vector<Triplet_t>& entries_init_B_cluster_i,
-		std::vector<Triplet_t>& entries_init_B_grad_cluster_i,
 		int num_neighbors,
 		const string_t& vecchia_neighbor_selection,
 		RNG_t& rng,
@@ -273,29 +280,52 @@ namespace GPBoost {
 		find_nearest_neighbors_Vecchia_fast(coords_scaled, num_re, num_neighbors,
 			nearest_neighbors_cluster_i, dist_dummy, dist_dummy, 0, -1, check_has_duplicates,
 			vecchia_neighbor_selection, rng, false);
-		int ctr = 0, ctr_grad = 0;
-		for (int i = 0; i < std::min(num_re, num_neighbors); ++i) {
+	}//end UpdateNearestNeighbors
+
+	/*!
+	* \brief Initialize the matrix B = I - A (or a matrix B_grad) for the Vecchia approximation directly in compressed form
+	*		This is equivalent to calling setFromTriplets with one triplet per neighbor entry (plus the diagonal),
+	*		but every entry is placed directly at its final position, so the sorting pass over all triplets is skipped
+	* \param num_re_cluster_i Number of random effects
+	* \param nearest_neighbors_cluster_i Collects indices of nearest neighbors
+	* \param with_diagonal If true, 1's are put on the diagonal (matrix B = I - A), otherwise there are no diagonal entries (matrices B_grad)
+	* \param[out] M Initialized matrix (all entries 0. except the 1's on the diagonal if with_diagonal is true)
+	*/
+	inline void InitializeBVecchia(data_size_t num_re_cluster_i,
+		const std::vector<std::vector<int>>& nearest_neighbors_cluster_i,
+		bool with_diagonal,
+		sp_mat_t& M) {
+		M = sp_mat_t(num_re_cluster_i, num_re_cluster_i);
+		std::vector<int> col_ptr(num_re_cluster_i + 1, 0);
+		for (data_size_t i = 0; i < num_re_cluster_i; ++i) {
 			for (int j = 0; j < (int)nearest_neighbors_cluster_i[i].size(); ++j) {
-				entries_init_B_cluster_i[ctr] = Triplet_t(i, nearest_neighbors_cluster_i[i][j], 0.);
-				entries_init_B_grad_cluster_i[ctr_grad] = Triplet_t(i, nearest_neighbors_cluster_i[i][j], 0.);
-				ctr++;
-				ctr_grad++;
+				col_ptr[nearest_neighbors_cluster_i[i][j] + 1]++;
+			}
+			if (with_diagonal) {
+				col_ptr[i + 1]++;
 			}
-			entries_init_B_cluster_i[ctr] = Triplet_t(i, i, 1.);//Put 1's on the diagonal since B = I - A
-			ctr++;
 		}
-		if (num_neighbors < num_re) {
-#pragma omp parallel for schedule(static)
-			for (int i = num_neighbors; i < num_re; ++i) {
-				CHECK((int)nearest_neighbors_cluster_i[i].size() == num_neighbors);
-				for (int j = 0; j < num_neighbors; ++j) {
-					entries_init_B_cluster_i[ctr + (i - num_neighbors) * (num_neighbors + 1) + j] = Triplet_t(i, nearest_neighbors_cluster_i[i][j], 0.);
-					entries_init_B_grad_cluster_i[ctr_grad + (i - num_neighbors) * num_neighbors + j] = Triplet_t(i, nearest_neighbors_cluster_i[i][j], 0.);
-				}
-				entries_init_B_cluster_i[ctr + (i - num_neighbors) * (num_neighbors + 1) + num_neighbors] = Triplet_t(i, i, 1.);//Put 1's on the diagonal since B = I - A
+		for (data_size_t icol = 0; icol < num_re_cluster_i; ++icol) {
+			col_ptr[icol + 1] += col_ptr[icol];
+		}
+		M.resizeNonZeros(col_ptr[num_re_cluster_i]);
+		std::copy(col_ptr.begin(), col_ptr.end(), M.outerIndexPtr());
+		//Fill the entries. Looping over the rows in increasing order guarantees sorted inner indices within every column
+		int* inner = M.innerIndexPtr();
+		double* values = M.valuePtr();
+		for (data_size_t i = 0; i < num_re_cluster_i; ++i) {
+			for (int j = 0; j < (int)nearest_neighbors_cluster_i[i].size(); ++j) {
+				int pos = col_ptr[nearest_neighbors_cluster_i[i][j]]++;
+				inner[pos] = i;
+				values[pos] = 0.;
+			}
+			if (with_diagonal) {
+				int pos = col_ptr[i]++;
+				inner[pos] = i;
+				values[pos] = 1.;//Put 1's on the diagonal since B = I - A
 			}
 		}
-	}//end UpdateNearestNeighbors
+	}//end InitializeBVecchia
 
 	/*!
 	* \brief Calculate matrices A and D_inv as well as their derivatives for the Vecchia approximation for one cluster (independent realization of GP)
@@ -305,8 +335,6 @@ namespace GPBoost {
 	* \param nearest_neighbors_cluster_i Collects indices of nearest neighbors
 	* \param dist_obs_neighbors_cluster_i Distances between locations and their nearest neighbors
 	* \param dist_between_neighbors_cluster_i Distances between nearest neighbors for all locations
-	* \param entries_init_B_cluster_i Triplets for initializing the matrices B
-	* \param entries_init_B_grad_cluster_i Triplets for initializing the matrices B_grad
 	* \param z_outer_z_obs_neighbors_cluster_i Outer product of covariate vector at observations and neighbors with itself for random coefficients. First index = data point i, second index = GP number j
 	* \param[out] B_cluster_i Matrix A = I - B (= Cholesky factor of inverse covariance) for Vecchia approximation
 	* \param[out] D_inv_cluster_i Diagonal matrices D^-1 for Vecchia approximation
@@ -326,8 +354,6 @@ namespace GPBoost {
 		const std::vector<std::vector<int>>& nearest_neighbors_cluster_i,
 		const std::vector<den_mat_t>& dist_obs_neighbors_cluster_i,
 		const std::vector<den_mat_t>& dist_between_neighbors_cluster_i,
-		const std::vector<Triplet_t>& entries_init_B_cluster_i,
-		const std::vector<Triplet_t>& entries_init_B_grad_cluster_i,
 		const std::vector<std::vector<den_mat_t>>& z_outer_z_obs_neighbors_cluster_i,
 		sp_mat_t& B_cluster_i,
 		sp_mat_t& D_inv_cluster_i,
@@ -342,169 +368,242 @@ namespace GPBoost {
 		int num_par_comp = re_comps_cluster_i[ind_intercept_gp]->NumCovPar();
 		int num_par_gp = num_par_comp * num_gp_total + calc_gradient_nugget;
 		//Initialize matrices B = I - A and D^-1 as well as their derivatives (in order that the code below can be run in parallel)
-		B_cluster_i = sp_mat_t(num_re_cluster_i, num_re_cluster_i);//B = I - A
-		B_cluster_i.setFromTriplets(entries_init_B_cluster_i.begin(), entries_init_B_cluster_i.end());//Note: 1's are put on the diagonal
+		InitializeBVecchia(num_re_cluster_i, nearest_neighbors_cluster_i, true, B_cluster_i);//B = I - A. Note: 1's are put on the diagonal
 		D_inv_cluster_i = sp_mat_t(num_re_cluster_i, num_re_cluster_i);//D^-1. Note: we first calculate D, and then take the inverse below
-		D_inv_cluster_i.setIdentity();//Put 1's on the diagonal for nugget effect (entries are not overriden but added below)
-		if (!transf_scale && gauss_likelihood) {
-			D_inv_cluster_i.diagonal().array() = nugget_var;//nugget effect is not 1 if not on transformed scale
-		}
-		if (!gauss_likelihood) {
-			D_inv_cluster_i.diagonal().array() = 0.;
-		}
+		D_inv_cluster_i.setIdentity();//initializes the diagonal sparsity pattern, the values are overwritten from the dense accumulator below
+		//The diagonals of D and D_grad are accumulated in dense vectors in the loop below and written into the
+		//	sparse matrices at the end, avoiding a search on the sparse diagonal (coeffRef) for every access
+		vec_t D_inv_vec(num_re_cluster_i);//Note: we first calculate D, and then take the inverse below
+		D_inv_vec.setConstant(gauss_likelihood ? (transf_scale ? 1. : nugget_var) : 0.);//1's on the diagonal for the nugget effect (nugget_var if not on the transformed scale)
 		bool exclude_marg_var_grad = !gauss_likelihood && (re_comps_cluster_i.size() == 1);//gradient is not needed if there is only one GP for non-Gaussian likelihoods
+		int ind_first_B_grad = exclude_marg_var_grad ? 1 : 0;//index of the first initialized B_grad matrix; all B_grad matrices share the same sparsity pattern
+		std::vector<vec_t> D_grad_vec;
 		if (calc_gradient) {
 			B_grad_cluster_i = std::vector<sp_mat_t>(num_par_gp);//derivative of B = derviateive of (-A)
 			D_grad_cluster_i = std::vector<sp_mat_t>(num_par_gp);//derivative of D
+			D_grad_vec = std::vector<vec_t>(num_par_gp);
 			for (int ipar = 0; ipar < num_par_gp; ++ipar) {
 				if (!(exclude_marg_var_grad && ipar == 0)) {
-					B_grad_cluster_i[ipar] = sp_mat_t(num_re_cluster_i, num_re_cluster_i);
-					B_grad_cluster_i[ipar].setFromTriplets(entries_init_B_grad_cluster_i.begin(), entries_init_B_grad_cluster_i.end());
+					if (ipar == ind_first_B_grad) {
+						InitializeBVecchia(num_re_cluster_i, nearest_neighbors_cluster_i, false, B_grad_cluster_i[ipar]);
+					}
+					else {
+						B_grad_cluster_i[ipar] = B_grad_cluster_i[ind_first_B_grad];//same pattern and initial values, copying is cheaper than rebuilding the pattern
+					}
 					D_grad_cluster_i[ipar] = sp_mat_t(num_re_cluster_i, num_re_cluster_i);
-					D_grad_cluster_i[ipar].setIdentity();//Put 0 on the diagonal
-					D_grad_cluster_i[ipar].diagonal().array() = 0.;
+					D_grad_cluster_i[ipar].setIdentity();//initializes the diagonal sparsity pattern, the values are overwritten from the dense accumulators at the end
+					D_grad_vec[ipar] = vec_t::Zero(num_re_cluster_i);
 				}
 			}
 		}//end initialization
 		std::shared_ptr<RECompGP<T_mat>> re_comp = std::dynamic_pointer_cast<RECompGP<T_mat>>(re_comps_cluster_i[ind_intercept_gp]);
 		bool distances_saved = re_comp->ShouldSaveDistances();
-#pragma omp parallel for schedule(static)
-		for (data_size_t i = 0; i < num_re_cluster_i; ++i) {
-			int num_nn = (int)nearest_neighbors_cluster_i[i].size();
-			//calculate covariance matrices between observations and neighbors and among neighbors as well as their derivatives
+		//select the GP components once here instead of re-indexing the vector of shared pointers for every point in the loop below
+		std::vector<RECompBase<T_mat>*> re_comps_gp(num_gp_total);
+		for (int j = 0; j < num_gp_total; ++j) {
+			re_comps_gp[j] = re_comps_cluster_i[ind_intercept_gp + j].get();
+		}
+		//marginal variances of the components (first summand of the diagonal of D); they do not depend on the data point,
+		//	so they are computed once here instead of for every point in the loop below
+		std::vector<double> d_comp_base(num_gp_total);
+		for (int j = 0; j < num_gp_total; ++j) {
+			d_comp_base[j] = re_comps_gp[j]->CovPars()[0];
+			if (!transf_scale && gauss_likelihood) {
+				d_comp_base[j] *= nugget_var;
+			}
+		}
+#pragma omp parallel
+		{
+			//Scratch matrices for calculating the covariance matrices between observations and neighbors and among neighbors
+			//	as well as their derivatives. They are declared outside the loop below such that every thread reuses
+			//	its buffers across iterations (the dimensions are usually constant) instead of reallocating them for every point
 			den_mat_t cov_mat_obs_neighbors;
 			den_mat_t cov_mat_between_neighbors;
 			std::vector<den_mat_t> cov_grad_mats_obs_neighbors(num_par_gp);//covariance matrix plus derivative wrt to every parameter
 			std::vector<den_mat_t> cov_grad_mats_between_neighbors(num_par_gp);
 			den_mat_t coords_i, coords_nn_i;
-			if (i > 0) {
-				for (int j = 0; j < num_gp_total; ++j) {
-					int ind_first_par = j * num_par_comp;//index of first parameter (variance) of component j in gradient vectors
-					if (j == 0) {
-						if (!distances_saved) {
-							std::vector<int> ind{ i };
-							re_comp->GetSubSetCoords(ind, coords_i);
-							re_comp->GetSubSetCoords(nearest_neighbors_cluster_i[i], coords_nn_i);
+			Eigen::LLT<den_mat_t> chol_fact_between_neighbors;//Cholesky factor of cov_mat_between_neighbors, its internal storage is likewise reused across iterations
+#pragma omp for schedule(static)
+			for (data_size_t i = 0; i < num_re_cluster_i; ++i) {
+				const std::vector<int>& nearest_neighbors_cluster_i_i = nearest_neighbors_cluster_i[i];//note: a reference, not a copy
+				int num_nn = (int)nearest_neighbors_cluster_i_i.size();
+				if (i > 0) {
+					for (int j = 0; j < num_gp_total; ++j) {
+						int ind_first_par = j * num_par_comp;//index of first parameter (variance) of component j in gradient vectors
+						if (j == 0) {
+							if (!distances_saved) {
+								std::vector<int> ind{ i };
+								re_comp->GetSubSetCoords(ind, coords_i);
+								re_comp->GetSubSetCoords(nearest_neighbors_cluster_i_i, coords_nn_i);
+							}
+							re_comps_gp[j]->CalcSigmaAndSigmaGradVecchia(dist_obs_neighbors_cluster_i[i], coords_i, coords_nn_i,
+								cov_mat_obs_neighbors, cov_grad_mats_obs_neighbors.data() + ind_first_par,
+								calc_gradient, transf_scale, nugget_var, false);//write on matrices directly for first GP component
+							re_comps_gp[j]->CalcSigmaAndSigmaGradVecchia(dist_between_neighbors_cluster_i[i], coords_nn_i, coords_nn_i,
+								cov_mat_between_neighbors, cov_grad_mats_between_neighbors.data() + ind_first_par,
+								calc_gradient, transf_scale, nugget_var, true);
 						}
-						re_comps_cluster_i[ind_intercept_gp + j]->CalcSigmaAndSigmaGradVecchia(dist_obs_neighbors_cluster_i[i], coords_i, coords_nn_i,
-							cov_mat_obs_neighbors, cov_grad_mats_obs_neighbors.data() + ind_first_par,
-							calc_gradient, transf_scale, nugget_var, false);//write on matrices directly for first GP component
-						re_comps_cluster_i[ind_intercept_gp + j]->CalcSigmaAndSigmaGradVecchia(dist_between_neighbors_cluster_i[i], coords_nn_i, coords_nn_i,
-							cov_mat_between_neighbors, cov_grad_mats_between_neighbors.data() + ind_first_par,
-							calc_gradient, transf_scale, nugget_var, true);
-					}
-					else {//random coefficient GPs
-						den_mat_t cov_mat_obs_neighbors_j;
-						den_mat_t cov_mat_between_neighbors_j;
-						re_comps_cluster_i[ind_intercept_gp + j]->CalcSigmaAndSigmaGradVecchia(dist_obs_neighbors_cluster_i[i], coords_i, coords_nn_i,
-							cov_mat_obs_neighbors_j, cov_grad_mats_obs_neighbors.data() + ind_first_par,
-							calc_gradient, transf_scale, nugget_var, false);
-						re_comps_cluster_i[ind_intercept_gp + j]->CalcSigmaAndSigmaGradVecchia(dist_between_neighbors_cluster_i[i], coords_nn_i, coords_nn_i,
-							cov_mat_between_neighbors_j, cov_grad_mats_between_neighbors.data() + ind_first_par,
-							calc_gradient, transf_scale, nugget_var, true);
-						//multiply by coefficient matrix
-						cov_mat_obs_neighbors_j.array() *= (z_outer_z_obs_neighbors_cluster_i[i][j - 1].block(1, 0, num_nn, 1)).array();//cov_mat_obs_neighbors_j.cwiseProduct()
-						//cov_mat_obs_neighbors_j.array() *= (z_outer_z_obs_neighbors_cluster_i[i][j - 1].block(0, 1, 1, num_nn)).array();//cov_mat_obs_neighbors_j.cwiseProduct()//DELETE_FIRST
-						cov_mat_between_neighbors_j.array() *= (z_outer_z_obs_neighbors_cluster_i[i][j - 1].block(1, 1, num_nn, num_nn)).array();
-						cov_mat_obs_neighbors += cov_mat_obs_neighbors_j;
-						cov_mat_between_neighbors += cov_mat_between_neighbors_j;
-						if (calc_gradient) {
-							for (int ipar = 0; ipar < (int)num_par_comp; ++ipar) {
-								cov_grad_mats_obs_neighbors[ind_first_par + ipar].array() *= (z_outer_z_obs_neighbors_cluster_i[i][j - 1].block(1, 0, num_nn, 1)).array();
-								cov_grad_mats_between_neighbors[ind_first_par + ipar].array() *= (z_outer_z_obs_neighbors_cluster_i[i][j - 1].block(1, 1, num_nn, num_nn)).array();
+						else {//random coefficient GPs
+							den_mat_t cov_mat_obs_neighbors_j;
+							den_mat_t cov_mat_between_neighbors_j;
+							re_comps_gp[j]->CalcSigmaAndSigmaGradVecchia(dist_obs_neighbors_cluster_i[i], coords_i, coords_nn_i,
+								cov_mat_obs_neighbors_j, cov_grad_mats_obs_neighbors.data() + ind_first_par,
+								calc_gradient, transf_scale, nugget_var, false);
+							re_comps_gp[j]->CalcSigmaAndSigmaGradVecchia(dist_between_neighbors_cluster_i[i], coords_nn_i, coords_nn_i,
+								cov_mat_between_neighbors_j, cov_grad_mats_between_neighbors.data() + ind_first_par,
+								calc_gradient, transf_scale, nugget_var, true);
+							//multiply by coefficient matrix
+							//	the two blocks of the outer product matrix are fetched only once here and reused below
+							const den_mat_t& z_outer_z_ij = z_outer_z_obs_neighbors_cluster_i[i][j - 1];
+							const auto z_obs_nn = z_outer_z_ij.block(1, 0, num_nn, 1).array();
+							const auto z_between_nn = z_outer_z_ij.block(1, 1, num_nn, num_nn).array();
+							cov_mat_obs_neighbors_j.array() *= z_obs_nn;//cov_mat_obs_neighbors_j.cwiseProduct()
+							//cov_mat_obs_neighbors_j.array() *= (z_outer_z_ij.block(0, 1, 1, num_nn)).array();//cov_mat_obs_neighbors_j.cwiseProduct()//DELETE_FIRST
+							cov_mat_between_neighbors_j.array() *= z_between_nn;
+							cov_mat_obs_neighbors += cov_mat_obs_neighbors_j;
+							cov_mat_between_neighbors += cov_mat_between_neighbors_j;
+							if (calc_gradient) {
+								for (int ipar = 0; ipar < (int)num_par_comp; ++ipar) {
+									cov_grad_mats_obs_neighbors[ind_first_par + ipar].array() *= z_obs_nn;
+									cov_grad_mats_between_neighbors[ind_first_par + ipar].array() *= z_between_nn;
+								}
 							}
 						}
+					}//end loop over components j
+				}//end if(i>1)
+				//Calculate matrices B and D as well as their derivatives
+				//1. add first summand of matrix D (ZCZ^T_{ii}) and its derivatives
+				for (int j = 0; j < num_gp_total; ++j) {
+					double d_comp_j = d_comp_base[j];
+					double z_sq_i_j = (j > 0) ? z_outer_z_obs_neighbors_cluster_i[i][j - 1](0, 0) : 1.;//Z_ij^2, fetched only once per component
+					if (j > 0) {//random coefficient
+						d_comp_j *= z_sq_i_j;
 					}
-				}//end loop over components j
-			}//end if(i>1)
-			//Calculate matrices B and D as well as their derivatives
-			//1. add first summand of matrix D (ZCZ^T_{ii}) and its derivatives
-			for (int j = 0; j < num_gp_total; ++j) {
-				double d_comp_j = re_comps_cluster_i[ind_intercept_gp + j]->CovPars()[0];
-				if (!transf_scale && gauss_likelihood) {
-					d_comp_j *= nugget_var;
-				}
-				if (j > 0) {//random coefficient
-					d_comp_j *= z_outer_z_obs_neighbors_cluster_i[i][j - 1](0, 0);
-				}
-				D_inv_cluster_i.coeffRef(i, i) += d_comp_j;
-				if (calc_gradient) {
-					if (!(exclude_marg_var_grad && j == 0)) {
-						if (transf_scale) {
-							D_grad_cluster_i[j * num_par_comp].coeffRef(i, i) = d_comp_j;//derivative of the covariance function wrt the variance. derivative of the covariance function wrt to range is zero on the diagonal
-						}
-						else {
-							if (j == 0) {
-								D_grad_cluster_i[j * num_par_comp].coeffRef(i, i) = 1.;//1's on the diagonal on the orignal scale
+					D_inv_vec[i] += d_comp_j;
+					if (calc_gradient) {
+						if (!(exclude_marg_var_grad && j == 0)) {
+							if (transf_scale) {
+								D_grad_vec[j * num_par_comp][i] = d_comp_j;//derivative of the covariance function wrt the variance. derivative of the covariance function wrt to range is zero on the diagonal
 							}
 							else {
-								D_grad_cluster_i[j * num_par_comp].coeffRef(i, i) = z_outer_z_obs_neighbors_cluster_i[i][j - 1](0, 0);
+								if (j == 0) {
+									D_grad_vec[j * num_par_comp][i] = 1.;//1's on the diagonal on the orignal scale
+								}
+								else {
+									D_grad_vec[j * num_par_comp][i] = z_sq_i_j;
+								}
 							}
 						}
 					}
 				}
-			}
-			if (calc_gradient && calc_gradient_nugget) {
-				D_grad_cluster_i[num_par_gp - 1].coeffRef(i, i) = 1.;
-			}
-			//2. remaining terms
-			if (i > 0) {
-				if (gauss_likelihood) {
-					if (transf_scale) {
-						cov_mat_between_neighbors.diagonal().array() += 1.;//add nugget effect
+				if (calc_gradient && calc_gradient_nugget) {
+					D_grad_vec[num_par_gp - 1][i] = 1.;
+				}
+				//2. remaining terms
+				if (i > 0) {
+					double add_diag;
+					if (gauss_likelihood) {
+						add_diag = transf_scale ? 1. : nugget_var;//add nugget effect
 					}
 					else {
-						cov_mat_between_neighbors.diagonal().array() += nugget_var;
+						add_diag = EPSILON_ADD_COVARIANCE_STABLE;//Avoid numerical problems when there is no nugget effect
 					}
-				}
-				else {
-					cov_mat_between_neighbors.diagonal().array() += EPSILON_ADD_COVARIANCE_STABLE;//Avoid numerical problems when there is no nugget effect
-				}
-				den_mat_t A_i(1, num_nn);
-				den_mat_t A_i_grad_sigma2;
-				Eigen::LLT<den_mat_t> chol_fact_between_neighbors = cov_mat_between_neighbors.llt();
-				A_i = (chol_fact_between_neighbors.solve(cov_mat_obs_neighbors)).transpose();
-				for (int inn = 0; inn < num_nn; ++inn) {
-					B_cluster_i.coeffRef(i, nearest_neighbors_cluster_i[i][inn]) = -A_i(0, inn);
-				}
-				D_inv_cluster_i.coeffRef(i, i) -= (A_i * cov_mat_obs_neighbors)(0, 0);
-				if (calc_gradient) {
-					if (calc_gradient_nugget) {
-						A_i_grad_sigma2 = -(chol_fact_between_neighbors.solve(A_i.transpose())).transpose();
+					double* cov_mat_between_neighbors_data = cov_mat_between_neighbors.data();
+					for (int inn = 0; inn < num_nn; ++inn) {//a plain strided loop instead of the Eigen diagonal expression
+						cov_mat_between_neighbors_data[inn * (num_nn + 1)] += add_diag;
 					}
-					den_mat_t A_i_grad(1, num_nn);
-					for (int j = 0; j < num_gp_total; ++j) {
-						int ind_first_par = j * num_par_comp;
-						for (int ipar = 0; ipar < num_par_comp; ++ipar) {
-							if (!(exclude_marg_var_grad && ipar == 0)) {
-								A_i_grad = (chol_fact_between_neighbors.solve(cov_grad_mats_obs_neighbors[ind_first_par + ipar])).transpose() -
-									A_i * ((chol_fact_between_neighbors.solve(cov_grad_mats_between_neighbors[ind_first_par + ipar])).transpose());
-								for (int inn = 0; inn < num_nn; ++inn) {
-									B_grad_cluster_i[ind_first_par + ipar].coeffRef(i, nearest_neighbors_cluster_i[i][inn]) = -A_i_grad(0, inn);
-								}
-								if (ipar == 0) {
-									D_grad_cluster_i[ind_first_par + ipar].coeffRef(i, i) -= ((A_i_grad * cov_mat_obs_neighbors)(0, 0) +
-										(A_i * cov_grad_mats_obs_neighbors[ind_first_par + ipar])(0, 0));//add to derivative of diagonal elements for marginal variance 
+					den_mat_t A_i(1, num_nn);
+					den_mat_t A_i_grad_sigma2;
+					chol_fact_between_neighbors.compute(cov_mat_between_neighbors);
+					A_i = (chol_fact_between_neighbors.solve(cov_mat_obs_neighbors)).transpose();
+					for (int inn = 0; inn < num_nn; ++inn) {
+						B_cluster_i.coeffRef(i, nearest_neighbors_cluster_i_i[inn]) = -A_i(0, inn);
+					}
+					D_inv_vec[i] -= A_i.row(0).dot(cov_mat_obs_neighbors.col(0));
+					if (calc_gradient) {
+						//Batch all single-column right-hand sides into one matrix and solve them with a single call
+						//	so that the Cholesky factor is traversed only once instead of once per parameter
+						den_mat_t sol_obs_grad;
+						int num_rhs = 0;
+						{
+							den_mat_t rhs_obs_grad(num_nn, num_par_gp);
+							for (int j = 0; j < num_gp_total; ++j) {
+								int ind_first_par = j * num_par_comp;
+								for (int ipar = 0; ipar < num_par_comp; ++ipar) {
+									if (!(exclude_marg_var_grad && ipar == 0)) {
+										rhs_obs_grad.col(num_rhs) = cov_grad_mats_obs_neighbors[ind_first_par + ipar];
+										num_rhs++;
+									}
 								}
-								else {
-									D_grad_cluster_i[ind_first_par + ipar].coeffRef(i, i) = -((A_i_grad * cov_mat_obs_neighbors)(0, 0) +
-										(A_i * cov_grad_mats_obs_neighbors[ind_first_par + ipar])(0, 0));//don't add to existing values since derivative of diagonal is zero for range
+							}
+							if (calc_gradient_nugget) {
+								rhs_obs_grad.col(num_rhs) = A_i.transpose();
+								num_rhs++;
+							}
+							sol_obs_grad = chol_fact_between_neighbors.solve(rhs_obs_grad.leftCols(num_rhs));
+						}
+						if (calc_gradient_nugget) {
+							A_i_grad_sigma2 = -(sol_obs_grad.col(num_rhs - 1).transpose());
+						}
+						//The B_grad matrices all share the same sparsity pattern. The positions of the entries of row i in the
+						//	value arrays are thus located only once and reused for all parameters below instead of
+						//	repeating the binary search of coeffRef for every single write
+						std::vector<int> pos_B_grad(num_nn);
+						if (ind_first_B_grad < num_par_gp) {
+							const int* inner_B_grad = B_grad_cluster_i[ind_first_B_grad].innerIndexPtr();
+							const int* outer_B_grad = B_grad_cluster_i[ind_first_B_grad].outerIndexPtr();
+							for (int inn = 0; inn < num_nn; ++inn) {
+								int col_nn = nearest_neighbors_cluster_i_i[inn];
+								pos_B_grad[inn] = (int)(std::lower_bound(inner_B_grad + outer_B_grad[col_nn],
+									inner_B_grad + outer_B_grad[col_nn + 1], (int)i) - inner_B_grad);
+							}
+						}
+						den_mat_t A_i_grad(1, num_nn);
+						int ind_rhs = 0;
+						for (int j = 0; j < num_gp_total; ++j) {
+							int ind_first_par = j * num_par_comp;
+							for (int ipar = 0; ipar < num_par_comp; ++ipar) {
+								if (!(exclude_marg_var_grad && ipar == 0)) {
+									A_i_grad = sol_obs_grad.col(ind_rhs).transpose() -
+										A_i * ((chol_fact_between_neighbors.solve(cov_grad_mats_between_neighbors[ind_first_par + ipar])).transpose());
+									ind_rhs++;
+									double* B_grad_val = B_grad_cluster_i[ind_first_par + ipar].valuePtr();
+									for (int inn = 0; inn < num_nn; ++inn) {
+										B_grad_val[pos_B_grad[inn]] = -A_i_grad(0, inn);
+									}
+									if (ipar == 0) {
+										D_grad_vec[ind_first_par + ipar][i] -= (A_i_grad.row(0).dot(cov_mat_obs_neighbors.col(0)) +
+											A_i.row(0).dot(cov_grad_mats_obs_neighbors[ind_first_par + ipar].col(0)));//add to derivative of diagonal elements for marginal variance
+									}
+									else {
+										D_grad_vec[ind_first_par + ipar][i] = -(A_i_grad.row(0).dot(cov_mat_obs_neighbors.col(0)) +
+											A_i.row(0).dot(cov_grad_mats_obs_neighbors[ind_first_par + ipar].col(0)));//don't add to existing values since derivative of diagonal is zero for range
+									}
 								}
 							}
 						}
-					}
-					if (calc_gradient_nugget) {
-						for (int inn = 0; inn < num_nn; ++inn) {
-							B_grad_cluster_i[num_par_gp - 1].coeffRef(i, nearest_neighbors_cluster_i[i][inn]) = -A_i_grad_sigma2(0, inn);
+						if (calc_gradient_nugget) {
+							double* B_grad_val = B_grad_cluster_i[num_par_gp - 1].valuePtr();
+							for (int inn = 0; inn < num_nn; ++inn) {
+								B_grad_val[pos_B_grad[inn]] = -A_i_grad_sigma2(0, inn);
+							}
+							D_grad_vec[num_par_gp - 1][i] -= A_i_grad_sigma2.row(0).dot(cov_mat_obs_neighbors.col(0));
 						}
-						D_grad_cluster_i[num_par_gp - 1].coeffRef(i, i) -= (A_i_grad_sigma2 * cov_mat_obs_neighbors)(0, 0);
-					}
-				}//end calc_gradient
-			}//end if i > 0
-			D_inv_cluster_i.coeffRef(i, i) = 1. / D_inv_cluster_i.coeffRef(i, i);
-		}//end loop over data i
-		Eigen::Index minRow, minCol;
-		double min_D_inv = D_inv_cluster_i.diagonal().minCoeff(&minRow, &minCol);
+					}//end calc_gradient
+				}//end if i > 0
+				D_inv_vec[i] = 1. / D_inv_vec[i];
+			}//end loop over data i
+		}//end omp parallel
+		//write the dense accumulators into the sparse diagonal matrices (exactly one entry per column)
+		Eigen::Map<vec_t>(D_inv_cluster_i.valuePtr(), num_re_cluster_i) = D_inv_vec;
+		if (calc_gradient) {
+			for (int ipar = 0; ipar < num_par_gp; ++ipar) {
+				if (!(exclude_marg_var_grad && ipar == 0)) {
+					Eigen::Map<vec_t>(D_grad_cluster_i[ipar].valuePtr(), num_re_cluster_i) = D_grad_vec[ipar];
+				}
+			}
+		}
+		double min_D_inv = D_inv_vec.minCoeff();
 		if (min_D_inv <= 0.) {
 			const char* min_D_inv_below_zero_msg = "The matrix D in the Vecchia approximation contains negative or zero values. "
 				"This likely results from numerical instabilities ";
@@ -582,7 +681,7 @@ namespace GPBoost {
 		bool distances_saved = re_comp->ShouldSaveDistances();
 		den_mat_t coords_scaled;
 		if (!distances_saved) {
-			const vec_t pars = re_comp->CovPars();
+			const vec_t& pars = re_comp->CovPars();
 			re_comp->ScaleCoordinates(pars, coords_all, coords_scaled);
 		}
 		if (CondObsOnly) {
@@ -618,7 +717,7 @@ namespace GPBoost {
 			}
 		}
 		//Random coefficients
-		std::vector<std::vector<den_mat_t>> z_outer_z_obs_neighbors_cluster_i(num_re_pred_cli);
+		std::vector<std::vector<vec_t>> z_coef_obs_neighbors_cluster_i(num_re_pred_cli);//covariate vector at point i and its neighbors for every random coefficient GP (only this vector is stored, the needed outer products are formed on the fly below)
 		if (num_gp_rand_coef > 0) {
 			for (int j = 0; j < num_gp_rand_coef; ++j) {
 				std::vector<double> rand_coef_data = re_comps[cluster_i][ind_intercept_gp + j + 1]->RandCoefData();//First entries are the observed data, then the predicted data
@@ -628,7 +727,7 @@ namespace GPBoost {
 #pragma omp for schedule(static)
 				for (int i = 0; i < num_re_pred_cli; ++i) {
 					if (j == 0) {
-						z_outer_z_obs_neighbors_cluster_i[i] = std::vector<den_mat_t>(num_gp_rand_coef);
+						z_coef_obs_neighbors_cluster_i[i] = std::vector<vec_t>(num_gp_rand_coef);
 					}
 					int dim_z = (int)nearest_neighbors_cluster_i[i].size() + 1;
 					vec_t coef_vec(dim_z);
@@ -638,94 +737,133 @@ namespace GPBoost {
 							coef_vec(ii) = rand_coef_data[nearest_neighbors_cluster_i[i][ii - 1]];
 						}
 					}
-					z_outer_z_obs_neighbors_cluster_i[i][j] = coef_vec * coef_vec.transpose();
+					z_coef_obs_neighbors_cluster_i[i][j] = coef_vec;
 				}
 			}
 		}
-		// Determine Triplet for initializing Bpo and Bp
-		std::vector<Triplet_t> entries_init_Bpo, entries_init_Bp;
+		//Initialize Bpo and Bp directly in compressed form (in order that the code below can be run in parallel);
+		//	the position of every neighbor entry in the value arrays is recorded so that the loop below
+		//	writes the values without any search (this replaces triplet lists, setFromTriplets, and the
+		//	binary search of coeffRef for every write)
+		Bpo = sp_mat_t(num_re_pred_cli, num_re_cli);
+		Bp = sp_mat_t(num_re_pred_cli, num_re_pred_cli);
+		Dp = vec_t(num_re_pred_cli);
+		std::vector<int> nn_entry_start(num_re_pred_cli + 1, 0);//start of the entries of point i in pos_nn_entries
+		std::vector<int> col_ptr_Bpo(num_re_cli + 1, 0), col_ptr_Bp(num_re_pred_cli + 1, 0);
 		for (int i = 0; i < num_re_pred_cli; ++i) {
-			entries_init_Bp.push_back(Triplet_t(i, i, 1.));//Put 1 on the diagonal
+			col_ptr_Bp[i + 1]++;//1's on the diagonal
 			for (int inn = 0; inn < (int)nearest_neighbors_cluster_i[i].size(); ++inn) {
 				if (nearest_neighbors_cluster_i[i][inn] < num_re_cli) {//nearest neighbor belongs to observed data
-					entries_init_Bpo.push_back(Triplet_t(i, nearest_neighbors_cluster_i[i][inn], 0.));
+					col_ptr_Bpo[nearest_neighbors_cluster_i[i][inn] + 1]++;
 				}
 				else {//nearest neighbor belongs to predicted data
-					entries_init_Bp.push_back(Triplet_t(i, nearest_neighbors_cluster_i[i][inn] - num_re_cli, 0.));
+					col_ptr_Bp[nearest_neighbors_cluster_i[i][inn] - num_re_cli + 1]++;
 				}
 			}
+			nn_entry_start[i + 1] = nn_entry_start[i] + (int)nearest_neighbors_cluster_i[i].size();
+		}
+		for (int icol = 0; icol < num_re_cli; ++icol) {
+			col_ptr_Bpo[icol + 1] += col_ptr_Bpo[icol];
+		}
+		for (int icol = 0; icol < num_re_pred_cli; ++icol) {
+			col_ptr_Bp[icol + 1] += col_ptr_Bp[icol];
+		}
+		Bpo.resizeNonZeros(col_ptr_Bpo[num_re_cli]);
+		Bp.resizeNonZeros(col_ptr_Bp[num_re_pred_cli]);
+		std::copy(col_ptr_Bpo.begin(), col_ptr_Bpo.end(), Bpo.outerIndexPtr());
+		std::copy(col_ptr_Bp.begin(), col_ptr_Bp.end(), Bp.outerIndexPtr());
+		std::vector<int> pos_nn_entries(nn_entry_start[num_re_pred_cli]);//position of the entry for neighbor inn of point i in the value array of Bpo or Bp
+		for (int i = 0; i < num_re_pred_cli; ++i) {//looping over the rows in increasing order guarantees sorted inner indices within every column
+			for (int inn = 0; inn < (int)nearest_neighbors_cluster_i[i].size(); ++inn) {
+				if (nearest_neighbors_cluster_i[i][inn] < num_re_cli) {
+					int pos = col_ptr_Bpo[nearest_neighbors_cluster_i[i][inn]]++;
+					Bpo.innerIndexPtr()[pos] = i;
+					Bpo.valuePtr()[pos] = 0.;
+					pos_nn_entries[nn_entry_start[i] + inn] = pos;
+				}
+				else {
+					int pos = col_ptr_Bp[nearest_neighbors_cluster_i[i][inn] - num_re_cli]++;
+					Bp.innerIndexPtr()[pos] = i;
+					Bp.valuePtr()[pos] = 0.;
+					pos_nn_entries[nn_entry_start[i] + inn] = pos;
+				}
+			}
+			int pos_diag = col_ptr_Bp[i]++;
+			Bp.innerIndexPtr()[pos_diag] = i;
+			Bp.valuePtr()[pos_diag] = 1.;//Put 1 on the diagonal
 		}
-		Bpo = sp_mat_t(num_re_pred_cli, num_re_cli);
-		Bp = sp_mat_t(num_re_pred_cli, num_re_pred_cli);
-		Dp = vec_t(num_re_pred_cli);
-		Bpo.setFromTriplets(entries_init_Bpo.begin(), entries_init_Bpo.end());//initialize matrices (in order that the code below can be run in parallel)
-		Bp.setFromTriplets(entries_init_Bp.begin(), entries_init_Bp.end());
 		if (gauss_likelihood) {
 			Dp.setOnes();//Put 1 on the diagonal (for nugget effect if gauss_likelihood, see comment below on why we add the nugget effect variance irrespective of 'predict_response')
 		}
 		else {
 			Dp.setZero();
 		}
-#pragma omp parallel for schedule(static)
-		for (int i = 0; i < num_re_pred_cli; ++i) {
-			int num_nn = (int)nearest_neighbors_cluster_i[i].size();
+		double* const B_val_ptrs[2] = { Bpo.valuePtr(), Bp.valuePtr() };//select the target matrix by index instead of a branch in the loop below
+#pragma omp parallel
+		{
+			//Scratch matrices and Cholesky factorization object, declared here such that every thread
+			//	reuses its allocations across the iterations below (the sizes are the same for most points)
 			den_mat_t cov_mat_obs_neighbors, cov_mat_between_neighbors;
 			den_mat_t cov_grad_dummy; //not used, just as mock argument for functions below
 			den_mat_t coords_i, coords_nn_i;
-			for (int j = 0; j < num_gp_total; ++j) {
-				if (j == 0) {
-					if (!distances_saved) {
-						std::vector<int> ind{ num_re_cli + i };
-						coords_i = coords_all(ind, Eigen::all);
-						coords_nn_i = coords_all(nearest_neighbors_cluster_i[i], Eigen::all);
+			Eigen::LLT<den_mat_t> chol_fact_between_neighbors;
+#pragma omp for schedule(static)
+			for (int i = 0; i < num_re_pred_cli; ++i) {
+				int num_nn = (int)nearest_neighbors_cluster_i[i].size();
+				for (int j = 0; j < num_gp_total; ++j) {
+					if (j == 0) {
+						if (!distances_saved) {
+							coords_i = coords_all.row(num_re_cli + i);//no temporary index vector needed for a single row
+							coords_nn_i = coords_all(nearest_neighbors_cluster_i[i], Eigen::all);
+						}
+						re_comps[cluster_i][ind_intercept_gp + j]->CalcSigmaAndSigmaGradVecchia(dist_obs_neighbors_cluster_i[i], coords_i, coords_nn_i,
+							cov_mat_obs_neighbors, &cov_grad_dummy, false, true, 1., false);//write on matrices directly for first GP component
+						re_comps[cluster_i][ind_intercept_gp + j]->CalcSigmaAndSigmaGradVecchia(dist_between_neighbors_cluster_i[i], coords_nn_i, coords_nn_i,
+							cov_mat_between_neighbors, &cov_grad_dummy, false, true, 1., true);
 					}
-					re_comps[cluster_i][ind_intercept_gp + j]->CalcSigmaAndSigmaGradVecchia(dist_obs_neighbors_cluster_i[i], coords_i, coords_nn_i,
-						cov_mat_obs_neighbors, &cov_grad_dummy, false, true, 1., false);//write on matrices directly for first GP component
-					re_comps[cluster_i][ind_intercept_gp + j]->CalcSigmaAndSigmaGradVecchia(dist_between_neighbors_cluster_i[i], coords_nn_i, coords_nn_i,
-						cov_mat_between_neighbors, &cov_grad_dummy, false, true, 1., true);
-				}
-				else {//random coefficient GPs
-					den_mat_t cov_mat_obs_neighbors_j;
-					den_mat_t cov_mat_between_neighbors_j;
-					re_comps[cluster_i][ind_intercept_gp + j]->CalcSigmaAndSigmaGradVecchia(dist_obs_neighbors_cluster_i[i], coords_i, coords_nn_i,
-						cov_mat_obs_neighbors_j, &cov_grad_dummy, false, true, 1., false);
-					re_comps[cluster_i][ind_intercept_gp + j]->CalcSigmaAndSigmaGradVecchia(dist_between_neighbors_cluster_i[i], coords_nn_i, coords_nn_i,
-						cov_mat_between_neighbors_j, &cov_grad_dummy, false, true, 1., true);
-					//multiply by coefficient matrix
-					cov_mat_obs_neighbors_j.array() *= (z_outer_z_obs_neighbors_cluster_i[i][j - 1].block(1, 0, num_nn, 1)).array();
-					cov_mat_between_neighbors_j.array() *= (z_outer_z_obs_neighbors_cluster_i[i][j - 1].block(1, 1, num_nn, num_nn)).array();
-					cov_mat_obs_neighbors += cov_mat_obs_neighbors_j;
-					cov_mat_between_neighbors += cov_mat_between_neighbors_j;
-				}
-			}//end loop over components j
-			//Calculate matrices A and D as well as their derivatives
-			//1. add first summand of matrix D (ZCZ^T_{ii})
-			for (int j = 0; j < num_gp_total; ++j) {
-				double d_comp_j = re_comps[cluster_i][ind_intercept_gp + j]->CovPars()[0];
-				if (j > 0) {//random coefficient
-					d_comp_j *= z_outer_z_obs_neighbors_cluster_i[i][j - 1](0, 0);
+					else {//random coefficient GPs
+						den_mat_t cov_mat_obs_neighbors_j;
+						den_mat_t cov_mat_between_neighbors_j;
+						re_comps[cluster_i][ind_intercept_gp + j]->CalcSigmaAndSigmaGradVecchia(dist_obs_neighbors_cluster_i[i], coords_i, coords_nn_i,
+							cov_mat_obs_neighbors_j, &cov_grad_dummy, false, true, 1., false);
+						re_comps[cluster_i][ind_intercept_gp + j]->CalcSigmaAndSigmaGradVecchia(dist_between_neighbors_cluster_i[i], coords_nn_i, coords_nn_i,
+							cov_mat_between_neighbors_j, &cov_grad_dummy, false, true, 1., true);
+						//multiply by coefficient matrix (outer products of the covariate vector formed lazily, entry by entry)
+						const vec_t& coef_vec_ij = z_coef_obs_neighbors_cluster_i[i][j - 1];
+						cov_mat_obs_neighbors_j.array() *= (coef_vec_ij(0) * coef_vec_ij.tail(num_nn)).array();
+						cov_mat_between_neighbors_j.array() *= (coef_vec_ij.tail(num_nn) * coef_vec_ij.tail(num_nn).transpose()).array();
+						cov_mat_obs_neighbors += cov_mat_obs_neighbors_j;
+						cov_mat_between_neighbors += cov_mat_between_neighbors_j;
+					}
+				}//end loop over components j
+				//Calculate matrices A and D as well as their derivatives
+				//1. add first summand of matrix D (ZCZ^T_{ii})
+				for (int j = 0; j < num_gp_total; ++j) {
+					double d_comp_j = re_comps[cluster_i][ind_intercept_gp + j]->CovPars()[0];
+					if (j > 0) {//random coefficient
+						double z_i_j = z_coef_obs_neighbors_cluster_i[i][j - 1](0);
+						d_comp_j *= z_i_j * z_i_j;
+					}
+					Dp[i] += d_comp_j;
 				}
-				Dp[i] += d_comp_j;
-			}
-			//2. remaining terms
-			if (gauss_likelihood) {
-				cov_mat_between_neighbors.diagonal().array() += 1.;//add nugget effect
-				//Note: we add the nugget effect variance irrespective of 'predict_response' since (i) this is numerically more stable and 
-				//	(ii) otherwise we would have to add it only for the neighbors in the observed training data if predict_response == false
-				//	If predict_response == false, the nugget variance is simply subtracted from the predictive covariance matrix later again.
-			}
-			den_mat_t A_i(1, num_nn);//dim = 1 x nn
-			A_i = (cov_mat_between_neighbors.llt().solve(cov_mat_obs_neighbors)).transpose();
-			for (int inn = 0; inn < num_nn; ++inn) {
-				if (nearest_neighbors_cluster_i[i][inn] < num_re_cli) {//nearest neighbor belongs to observed data
-					Bpo.coeffRef(i, nearest_neighbors_cluster_i[i][inn]) -= A_i(0, inn);
+				//2. remaining terms
+				if (gauss_likelihood) {
+					cov_mat_between_neighbors.diagonal().array() += 1.;//add nugget effect
+					//Note: we add the nugget effect variance irrespective of 'predict_response' since (i) this is numerically more stable and 
+					//	(ii) otherwise we would have to add it only for the neighbors in the observed training data if predict_response == false
+					//	If predict_response == false, the nugget variance is simply subtracted from the predictive covariance matrix later again.
 				}
-				else {
-					Bp.coeffRef(i, nearest_neighbors_cluster_i[i][inn] - num_re_cli) -= A_i(0, inn);
+				den_mat_t A_i(1, num_nn);//dim = 1 x nn
+				chol_fact_between_neighbors.compute(cov_mat_between_neighbors);
+				A_i = (chol_fact_between_neighbors.solve(cov_mat_obs_neighbors)).transpose();
+				const int* pos_nn_i = pos_nn_entries.data() + nn_entry_start[i];
+				for (int inn = 0; inn < num_nn; ++inn) {
+					//index 0 = Bpo (nearest neighbor belongs to observed data), index 1 = Bp (belongs to predicted data)
+					B_val_ptrs[nearest_neighbors_cluster_i[i][inn] >= num_re_cli][pos_nn_i[inn]] -= A_i(0, inn);
 				}
-			}
-			Dp[i] -= (A_i * cov_mat_obs_neighbors)(0, 0);
-		}//end loop over data i
+				Dp[i] -= A_i.row(0).dot(cov_mat_obs_neighbors.col(0));
+			}//end loop over data i
+		}//end omp parallel
 		if (gauss_likelihood) {
 			pred_mean = -Bpo * y_cluster_i;
 			if (!CondObsOnly) {
@@ -747,14 +885,18 @@ namespace GPBoost {
 					sp_mat_t Bp_inv(num_re_pred_cli, num_re_pred_cli);
 					Bp_inv.setIdentity();
 					TriangularSolve<sp_mat_t, sp_mat_t, sp_mat_t>(Bp, Bp_inv, Bp_inv, false);
-					sp_mat_t Bp_inv_Dp = Bp_inv * Dp.asDiagonal();
 					if (calc_pred_cov) {
+						sp_mat_t Bp_inv_Dp = Bp_inv * Dp.asDiagonal();
 						pred_cov = T_mat(Bp_inv_Dp * Bp_inv.transpose());
 					}
-					if (calc_pred_var) {
-#pragma omp parallel for schedule(static)
-						for (int i = 0; i < num_re_pred_cli; ++i) {
-							pred_var[i] = (Bp_inv_Dp.row(i)).dot(Bp_inv.row(i));
+					if (calc_pred_var) {//accumulate pred_var[i] = sum_j Dp[j] * Bp_inv(i,j)^2 in a single pass over the
+						//	non-zero entries of Bp_inv instead of extracting rows of a column-major matrix per point
+						pred_var.setZero();
+						for (int j = 0; j < Bp_inv.outerSize(); ++j) {
+							double Dp_j = Dp[j];
+							for (sp_mat_t::InnerIterator it(Bp_inv, j); it; ++it) {
+								pred_var[it.row()] += Dp_j * it.value() * it.value();
+							}
 						}
 					}
 				}
@@ -827,7 +969,7 @@ namespace GPBoost {
 				vecchia_neighbor_selection, rng, distances_saved);
 		}
 		else {
-			const vec_t pars = re_comp->CovPars();
+			const vec_t& pars = re_comp->CovPars();
 			re_comp->ScaleCoordinates(pars, coords_all, coords_scaled);
 			find_nearest_neighbors_Vecchia_fast(coords_scaled, num_data_tot, num_neighbors_pred,
 				nearest_neighbors_cluster_i, dist_obs_neighbors_cluster_i, dist_between_neighbors_cluster_i, 0, -1, check_has_duplicates,
@@ -961,10 +1103,10 @@ namespace GPBoost {
 					}
 				}
 				if (i < num_data_pred_cli) {
-					Dp_inv[i] -= (A_i * cov_mat_obs_neighbors)(0, 0);
+					Dp_inv[i] -= A_i.row(0).dot(cov_mat_obs_neighbors.col(0));
 				}
 				else {
-					Do_inv[i - num_data_pred_cli] -= (A_i * cov_mat_obs_neighbors)(0, 0);
+					Do_inv[i - num_data_pred_cli] -= A_i.row(0).dot(cov_mat_obs_neighbors.col(0));
 				}
 			}
 			if (i < num_data_pred_cli) {
@@ -1054,20 +1196,6 @@ namespace GPBoost {
 		else {
 			coords_all_unique = coords_all(uniques, Eigen::all);
 		}
-		//Determine incidence matrices
-		sp_mat_t Z_o = sp_mat_t(num_data_cli, uniques.size());
-		sp_mat_t Z_p = sp_mat_t(num_data_pred_cli, uniques.size());
-		std::vector<Triplet_t> entries_Z_o, entries_Z_p;
-		for (int i = 0; i < num_data_tot; ++i) {
-			if (i < num_data_cli) {
-				entries_Z_o.push_back(Triplet_t(i, unique_idx[i], 1.));
-			}
-			else {
-				entries_Z_p.push_back(Triplet_t(i - num_data_cli, unique_idx[i], 1.));
-			}
-		}
-		Z_o.setFromTriplets(entries_Z_o.begin(), entries_Z_o.end());
-		Z_p.setFromTriplets(entries_Z_p.begin(), entries_Z_p.end());
 		std::vector<std::vector<int>> nearest_neighbors_cluster_i(num_coord_unique);
 		std::vector<den_mat_t> dist_obs_neighbors_cluster_i(num_coord_unique);
 		std::vector<den_mat_t> dist_between_neighbors_cluster_i(num_coord_unique);
@@ -1076,7 +1204,7 @@ namespace GPBoost {
 		bool distances_saved = re_comp->ShouldSaveDistances();
 		den_mat_t coords_scaled;
 		if (!distances_saved) {
-			const vec_t pars = re_comp->CovPars();
+			const vec_t& pars = re_comp->CovPars();
 			re_comp->ScaleCoordinates(pars, coords_all_unique, coords_scaled);
 		}
 		if (CondObsOnly) {//find neighbors among both the observed locations only
@@ -1107,66 +1235,135 @@ namespace GPBoost {
 			Log::REFatal("Duplicates found among training and test coordinates. "
 				"This is not supported for predictions with a Vecchia approximation for the latent process ('latent_') ");
 		}
-		// Determine Triplet for initializing Bpo and Bp
-		std::vector<Triplet_t> entries_init_B;
+		//Initialize B directly in compressed form (in order that the code below can be run in parallel);
+		//	the position of every neighbor entry in the value array is recorded so that the loop below
+		//	writes the weights without the per-entry search of coeffRef
+		sp_mat_t B(num_coord_unique, num_coord_unique);
+		std::vector<int> nn_entry_start_B(num_coord_unique + 1, 0);//start of the entries of point i in pos_nn_entries_B
+		std::vector<int> col_ptr_B(num_coord_unique + 1, 0);
 		for (int i = 0; i < num_coord_unique; ++i) {
-			entries_init_B.push_back(Triplet_t(i, i, 1.));//Put 1 on the diagonal
+			col_ptr_B[i + 1]++;//1's on the diagonal
 			for (int inn = 0; inn < (int)nearest_neighbors_cluster_i[i].size(); ++inn) {
-				entries_init_B.push_back(Triplet_t(i, nearest_neighbors_cluster_i[i][inn], 0.));
+				col_ptr_B[nearest_neighbors_cluster_i[i][inn] + 1]++;
 			}
+			nn_entry_start_B[i + 1] = nn_entry_start_B[i] + (int)nearest_neighbors_cluster_i[i].size();
 		}
-		sp_mat_t B(num_coord_unique, num_coord_unique);
-		B.setFromTriplets(entries_init_B.begin(), entries_init_B.end());//initialize matrices (in order that the code below can be run in parallel)
+		for (int icol = 0; icol < num_coord_unique; ++icol) {
+			col_ptr_B[icol + 1] += col_ptr_B[icol];
+		}
+		B.resizeNonZeros(col_ptr_B[num_coord_unique]);
+		std::copy(col_ptr_B.begin(), col_ptr_B.end(), B.outerIndexPtr());
+		std::vector<int> pos_nn_entries_B(nn_entry_start_B[num_coord_unique]);//position of the entry for neighbor inn of point i in the value array of B
+		for (int i = 0; i < num_coord_unique; ++i) {//looping over the rows in increasing order guarantees sorted inner indices within every column
+			int pos_diag = col_ptr_B[i]++;
+			B.innerIndexPtr()[pos_diag] = i;
+			B.valuePtr()[pos_diag] = 1.;//Put 1 on the diagonal
+			for (int inn = 0; inn < (int)nearest_neighbors_cluster_i[i].size(); ++inn) {
+				int pos = col_ptr_B[nearest_neighbors_cluster_i[i][inn]]++;
+				B.innerIndexPtr()[pos] = i;
+				B.valuePtr()[pos] = 0.;
+				pos_nn_entries_B[nn_entry_start_B[i] + inn] = pos;
+			}
+		}
+		double* const B_val = B.valuePtr();
 		vec_t D(num_coord_unique);
-#pragma omp parallel for schedule(static)
-		for (int i = 0; i < num_coord_unique; ++i) {
-			int num_nn = (int)nearest_neighbors_cluster_i[i].size();
-			//define covariance and gradient matrices
+#pragma omp parallel
+		{
+			//Scratch matrices, declared here such that every thread reuses its allocations
+			//	across the iterations below (the sizes are the same for most points)
 			den_mat_t cov_mat_obs_neighbors, cov_mat_between_neighbors;
 			den_mat_t cov_grad_dummy; //not used, just as mock argument for functions below
 			den_mat_t coords_i, coords_nn_i;
-			if (i > 0) {
-				if (!distances_saved) {
-					std::vector<int> ind{ i };
-					coords_i = coords_all_unique(ind, Eigen::all);
-					coords_nn_i = coords_all_unique(nearest_neighbors_cluster_i[i], Eigen::all);
+			//Cholesky factorization object, declared here such that every thread reuses its internal storage
+			Eigen::LLT<den_mat_t> chol_fact_between_neighbors;
+#pragma omp for schedule(static)
+			for (int i = 0; i < num_coord_unique; ++i) {
+				int num_nn = (int)nearest_neighbors_cluster_i[i].size();
+				if (i > 0) {
+					if (!distances_saved) {
+						coords_i = coords_all_unique.row(i);//no temporary index vector needed for a single row
+						coords_nn_i = coords_all_unique(nearest_neighbors_cluster_i[i], Eigen::all);
+					}
+					re_comps[cluster_i][ind_intercept_gp]->CalcSigmaAndSigmaGradVecchia(dist_obs_neighbors_cluster_i[i], coords_i, coords_nn_i,
+						cov_mat_obs_neighbors, &cov_grad_dummy, false, true, 1., false);//write on matrices directly for first GP component
+					re_comps[cluster_i][ind_intercept_gp]->CalcSigmaAndSigmaGradVecchia(dist_between_neighbors_cluster_i[i], coords_nn_i, coords_nn_i,
+						cov_mat_between_neighbors, &cov_grad_dummy, false, true, 1., true);
 				}
-				re_comps[cluster_i][ind_intercept_gp]->CalcSigmaAndSigmaGradVecchia(dist_obs_neighbors_cluster_i[i], coords_i, coords_nn_i,
-					cov_mat_obs_neighbors, &cov_grad_dummy, false, true, 1., false);//write on matrices directly for first GP component
-				re_comps[cluster_i][ind_intercept_gp]->CalcSigmaAndSigmaGradVecchia(dist_between_neighbors_cluster_i[i], coords_nn_i, coords_nn_i,
-					cov_mat_between_neighbors, &cov_grad_dummy, false, true, 1., true);
-			}
-			//Calculate matrices A and D as well as their derivatives
-			//1. add first summand of matrix D (ZCZ^T_{ii})
-			D[i] = re_comps[cluster_i][ind_intercept_gp]->CovPars()[0];
-			//2. remaining terms
-			if (i > 0) {
-				den_mat_t A_i(1, num_nn);//dim = 1 x nn
-				A_i = (cov_mat_between_neighbors.llt().solve(cov_mat_obs_neighbors)).transpose();
-				for (int inn = 0; inn < num_nn; ++inn) {
-					B.coeffRef(i, nearest_neighbors_cluster_i[i][inn]) -= A_i(0, inn);
+				//Calculate matrices A and D as well as their derivatives
+				//1. add first summand of matrix D (ZCZ^T_{ii})
+				D[i] = re_comps[cluster_i][ind_intercept_gp]->CovPars()[0];
+				//2. remaining terms
+				if (i > 0) {
+					den_mat_t A_i(1, num_nn);//dim = 1 x nn
+					chol_fact_between_neighbors.compute(cov_mat_between_neighbors);
+					A_i = (chol_fact_between_neighbors.solve(cov_mat_obs_neighbors)).transpose();
+					const int* pos_nn_i = pos_nn_entries_B.data() + nn_entry_start_B[i];
+					for (int inn = 0; inn < num_nn; ++inn) {
+						B_val[pos_nn_i[inn]] -= A_i(0, inn);
+					}
+					D[i] -= A_i.row(0).dot(cov_mat_obs_neighbors.col(0));
 				}
-				D[i] -= (A_i * cov_mat_obs_neighbors)(0, 0);
-			}
-		}//end loop over data i
-		//Calculate D_inv and B_inv in order to calcualte Sigma and Sigma^-1
+			}//end loop over data i
+		}//end omp parallel
+		//Calculate D_inv in order to calcualte Sigma and Sigma^-1
 		vec_t D_inv = D.cwiseInverse();
-		sp_mat_t B_inv(num_coord_unique, num_coord_unique);
-		B_inv.setIdentity();
-		TriangularSolve<sp_mat_t, sp_mat_t, sp_mat_t>(B, B_inv, B_inv, false);
 		//Calculate inverse of covariance matrix for observed data using the Woodbury identity
-		sp_mat_t M_aux_Woodbury = B.transpose() * D_inv.asDiagonal() * B + Z_o.transpose() * Z_o;
+		//	Z_o' * Z_o is diagonal with the number of observations per unique location (every row of Z_o has a single 1),
+		//	so it is added directly to the diagonal instead of through a sparse product and sum
+		vec_t obs_count_per_unique = vec_t::Zero(num_coord_unique);
+		for (int i = 0; i < num_data_cli; ++i) {
+			obs_count_per_unique[unique_idx[i]] += 1.;
+		}
+		sp_mat_t M_aux_Woodbury = B.transpose() * D_inv.asDiagonal() * B;
+		for (int j = 0; j < num_coord_unique; ++j) {
+			M_aux_Woodbury.coeffRef(j, j) += obs_count_per_unique[j];//the diagonal is structurally non-zero since B has a unit diagonal
+		}
 		chol_sp_mat_t CholFac_M_aux_Woodbury;
 		CholFac_M_aux_Woodbury.compute(M_aux_Woodbury);
 		if (calc_pred_cov || calc_pred_var) {
+			//Determine incidence matrices (only needed here; the mean-only branch applies them as gather/scatter loops).
+			//	They are assembled directly in compressed form: one entry per row, counted per column and
+			//	placed with rows in increasing order so that the inner indices are sorted
+			sp_mat_t Z_o = sp_mat_t(num_data_cli, num_coord_unique);
+			sp_mat_t Z_p = sp_mat_t(num_data_pred_cli, num_coord_unique);
+			std::vector<int> col_ptr_Z_o(num_coord_unique + 1, 0), col_ptr_Z_p(num_coord_unique + 1, 0);
+			for (int i = 0; i < num_data_cli; ++i) {
+				col_ptr_Z_o[unique_idx[i] + 1]++;
+			}
+			for (int i = 0; i < num_data_pred_cli; ++i) {
+				col_ptr_Z_p[unique_idx[num_data_cli + i] + 1]++;
+			}
+			for (int icol = 0; icol < num_coord_unique; ++icol) {
+				col_ptr_Z_o[icol + 1] += col_ptr_Z_o[icol];
+				col_ptr_Z_p[icol + 1] += col_ptr_Z_p[icol];
+			}
+			Z_o.resizeNonZeros(num_data_cli);
+			Z_p.resizeNonZeros(num_data_pred_cli);
+			std::copy(col_ptr_Z_o.begin(), col_ptr_Z_o.end(), Z_o.outerIndexPtr());
+			std::copy(col_ptr_Z_p.begin(), col_ptr_Z_p.end(), Z_p.outerIndexPtr());
+			for (int i = 0; i < num_data_cli; ++i) {
+				int pos = col_ptr_Z_o[unique_idx[i]]++;
+				Z_o.innerIndexPtr()[pos] = i;
+				Z_o.valuePtr()[pos] = 1.;
+			}
+			for (int i = 0; i < num_data_pred_cli; ++i) {
+				int pos = col_ptr_Z_p[unique_idx[num_data_cli + i]]++;
+				Z_p.innerIndexPtr()[pos] = i;
+				Z_p.valuePtr()[pos] = 1.;
+			}
+			//B_inv is only materialized here; the mean-only branch below applies B^-1 and B^-T through triangular solves
+			sp_mat_t B_inv(num_coord_unique, num_coord_unique);
+			B_inv.setIdentity();
+			TriangularSolve<sp_mat_t, sp_mat_t, sp_mat_t>(B, B_inv, B_inv, false);
 			sp_mat_t Identity_obs(num_data_cli, num_data_cli);
 			Identity_obs.setIdentity();
 			sp_mat_t MInvSqrtX_Z_o_T;
 			TriangularSolveGivenCholesky<chol_sp_mat_t, sp_mat_t, sp_mat_t, sp_mat_t>(CholFac_M_aux_Woodbury, Z_o.transpose(), MInvSqrtX_Z_o_T, false);
 			sp_mat_t ZoSigmaZoT_plusI_Inv = -MInvSqrtX_Z_o_T.transpose() * MInvSqrtX_Z_o_T + Identity_obs;
 			sp_mat_t Z_p_B_inv = Z_p * B_inv;
+			sp_mat_t Z_o_B_inv = Z_o * B_inv;//select the needed rows of B_inv first instead of transposing all of B_inv below
 			sp_mat_t Z_p_B_inv_D = Z_p_B_inv * D.asDiagonal();
-			sp_mat_t ZpSigmaZoT = Z_p_B_inv_D * (B_inv.transpose() * Z_o.transpose());
+			sp_mat_t ZpSigmaZoT = Z_p_B_inv_D * Z_o_B_inv.transpose();
 			sp_mat_t M_aux = ZpSigmaZoT * ZoSigmaZoT_plusI_Inv;
 			pred_mean = M_aux * y_cluster_i;
 			if (calc_pred_cov) {
@@ -1176,21 +1373,47 @@ namespace GPBoost {
 				}
 			}
 			if (calc_pred_var) {
-				pred_var = vec_t(num_data_pred_cli);
-#pragma omp parallel for schedule(static)
-				for (int i = 0; i < num_data_pred_cli; ++i) {
-					pred_var[i] = (Z_p_B_inv_D.row(i)).dot(Z_p_B_inv.row(i)) - (M_aux.row(i)).dot(ZpSigmaZoT.row(i));
+				//accumulate both terms in single passes over the non-zeros instead of extracting
+				//	rows of column-major matrices per prediction point
+				pred_var = vec_t::Zero(num_data_pred_cli);
+				for (int j = 0; j < Z_p_B_inv.outerSize(); ++j) {
+					double D_j = D[j];
+					for (sp_mat_t::InnerIterator it(Z_p_B_inv, j); it; ++it) {
+						pred_var[it.row()] += D_j * it.value() * it.value();
+					}
 				}
+				sp_mat_t M_aux_ZpSigmaZoT = M_aux.cwiseProduct(ZpSigmaZoT);
+				vec_t pred_var_part2 = vec_t::Zero(num_data_pred_cli);
+				for (int k = 0; k < M_aux_ZpSigmaZoT.outerSize(); ++k) {
+					for (sp_mat_t::InnerIterator it(M_aux_ZpSigmaZoT, k); it; ++it) {
+						pred_var_part2[it.row()] += it.value();
+					}
+				}
+				pred_var -= pred_var_part2;
 				if (predict_response) {
 					pred_var.array() += 1.;
 				}
 			}
 		}//end calc_pred_cov || calc_pred_var
 		else {
-			vec_t resp_aux = Z_o.transpose() * y_cluster_i;
+			vec_t resp_aux = vec_t::Zero(num_coord_unique);
+			for (int i = 0; i < num_data_cli; ++i) {//resp_aux = Z_o' * y_cluster_i (scatter-add instead of a sparse product)
+				resp_aux[unique_idx[i]] += y_cluster_i[i];
+			}
 			vec_t resp_aux2 = CholFac_M_aux_Woodbury.solve(resp_aux);
-			resp_aux = y_cluster_i - Z_o * resp_aux2;
-			pred_mean = Z_p * (B_inv * (D.asDiagonal() * (B_inv.transpose() * (Z_o.transpose() * resp_aux))));
+			resp_aux.setZero();
+			for (int i = 0; i < num_data_cli; ++i) {//resp_aux = Z_o' * (y_cluster_i - Z_o * resp_aux2) (gather and scatter-add)
+				resp_aux[unique_idx[i]] += y_cluster_i[i] - resp_aux2[unique_idx[i]];
+			}
+			//apply Sigma = B^-1 D B^-T with two sparse triangular solves instead of materializing B_inv
+			sp_L_t_solve(B.valuePtr(), B.innerIndexPtr(), B.outerIndexPtr(), num_coord_unique, resp_aux.data());
+			vec_t pred_mean_unique = D.cwiseProduct(resp_aux);
+			sp_L_solve(B.valuePtr(), B.innerIndexPtr(), B.outerIndexPtr(), num_coord_unique, pred_mean_unique.data());
+			pred_mean = vec_t(num_data_pred_cli);
+#pragma omp parallel for schedule(static)
+			for (int i = 0; i < num_data_pred_cli; ++i) {//pred_mean = Z_p * pred_mean_unique (gather)
+				pred_mean[i] = pred_mean_unique[unique_idx[num_data_cli + i]];
+			}
 		}
 	}//end CalcPredVecchiaLatentObservedFirstOrder
 
@@ -68,19 +68,22 @@ namespace GPBoost {
 		bool has_covariates = re_model_templ_->HasCovariates();
 		bool should_print_trace = false;
 		bool should_redetermine_neighbors_vecchia = false;
+		bool is_sentinel_call = false;//calls from the optimizer that only print trace information or redetermine neighbors; the likelihood and gradient are never computed for these
 		if (gradient != nullptr) {//"hack" for printing nice logging information and redermininig neighbors for the Vecchia approximation
 			if ((*gradient).size() == 3 || (*gradient).size() == 2) {
 				if ((*gradient)[0] >= -1.00000000002e30 && (*gradient)[0] <= -1e30 && (*gradient)[1] >= 1e30 && (*gradient)[1] <= 1.00000000002e30) {
 					should_print_trace = true;
+					is_sentinel_call = true;
 				}
 				else if ((*gradient)[0] >= 1e30 && (*gradient)[0] <= 1.00000000002e30 && (*gradient)[1] >= -1.00000000002e30 && (*gradient)[1] <= -1e30) {
+					is_sentinel_call = true;//also when the neighbors are not redetermined (e.g. covariance parameters not estimated), such a call must not trigger a likelihood or gradient computation
 					if (objfn_data->learn_cov_aux_pars_) {
 						should_redetermine_neighbors_vecchia = true;
 					}
 				}
 			}
 		}
-		bool calc_likelihood = !should_redetermine_neighbors_vecchia && !should_print_trace;
+		bool calc_likelihood = !is_sentinel_call;
 		// Determine number of covariance and linear regression coefficient parameters
 		int num_cov_pars_optim = 0, num_covariates = 0, num_aux_pars = 0;
 		if (objfn_data->learn_cov_aux_pars_) {
@@ -142,6 +145,9 @@ namespace GPBoost {
 				re_model_templ_->SetNumIter((int)objfn_data->settings_->opt_iter);
 				if (re_model_templ_->ShouldRedetermineNearestNeighborsVecchia()) {
 					re_model_templ_->RedetermineNearestNeighborsVecchia(); // called only in certain iterations if gp_approx == "vecchia" and neighbors are selected based on correlations and not distances
+					if ((*gradient).size() == 3) {
+						(*gradient)[2] = 1.;//signal back to the optimizer that the objective function has changed so that cached function values are discarded
+					}
 				}
 			} //end should_redetermine_neighbors_vecchia
 			if (calc_likelihood) {
@@ -172,7 +178,7 @@ namespace GPBoost {
 				}
 			}//end calc_likelihood
 			// Calculate gradient
-			if (gradient && !should_redetermine_neighbors_vecchia) {
+			if (gradient && !is_sentinel_call) {
 				vec_t grad_cov, grad_beta;
 				re_model_templ_->CalcGradPars(cov_pars, cov_pars[0], objfn_data->learn_cov_aux_pars_, has_covariates, 
 					grad_cov, grad_beta, gradient_contains_error_var, false, fixed_effects_ptr, false);
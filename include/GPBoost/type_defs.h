@@ -28,6 +28,7 @@ namespace GPBoost {
 
 	/*! \brief Type of Eigen matrices */
 	typedef Eigen::MatrixXd den_mat_t;
+	typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> den_mat_rm_t; // row-major dense matrix
 	typedef Eigen::VectorXd vec_t;
 	typedef Eigen::VectorXi vec_int_t;
 	typedef Eigen::SparseVector<double> sp_vec_t;
@@ -104,6 +104,28 @@ namespace GPBoost {
 		}
 	}
 
+	/*!
+	* \brief Inserts a new candidate into the parallel arrays a (values, sorted in increasing order) and b (payload, e.g. indices)
+	*		by sinking it into its sorted position in a single pass.
+	*		Equivalent to overwriting the last entries with (a_new, b_new) and calling SortVectorsDecreasing, since only the new element is out of place
+	* \param a Sorted vector of values
+	* \param b Vector which is ordered based on the order in a
+	* \param n Length of vectors
+	* \param a_new New value (needs to be smaller than a[n-1])
+	* \param b_new Payload of the new value
+	*/
+	template <typename T>
+	inline void InsertNeighborSorted(T* a, int* b, int n, T a_new, int b_new) {
+		int k = n - 1;
+		while (k > 0 && a_new < a[k - 1]) {
+			a[k] = a[k - 1];
+			b[k] = b[k - 1];
+			k--;
+		}
+		a[k] = a_new;
+		b[k] = b_new;
+	}
+
 	/*!
 	* \brief Sample k integers from 0:(N-1) without replacement while excluding some indices
 	*		Source: see https://www.nowherenearithaca.com/2013/05/robert-floyds-tiny-and-beautiful.html and https://stackoverflow.com/questions/28287138/c-randomly-sample-k-numbers-from-range-0n-1-n-k-without-replacement
@@ -111,13 +133,18 @@ namespace GPBoost {
 	* \param k Size of integer set which is drawn
 	* \param gen RNG
 	* \param[out] indices Drawn integers
-	* \param exclude Excluded integers
+	* \param exclude Excluded integers (only the first num_exclude entries are used)
+	* \param num_exclude Number of excluded integers
 	*/
 	inline void SampleIntNoReplaceExcludeSomeIndices(int N,
 		int k,
 		RNG_t& gen,
 		std::vector<int>& indices,
-		const std::vector<int>& exclude) {
+		const std::vector<int>& exclude,
+		int num_exclude) {
+		//sort the excluded indices once so that every draw can be checked with a binary search instead of a linear scan
+		std::vector<int> exclude_sorted(exclude.begin(), exclude.begin() + num_exclude);
+		std::sort(exclude_sorted.begin(), exclude_sorted.end());
 		for (int r = N - k; r < N; ++r) {
 			int v = std::uniform_int_distribution<>(0, r)(gen);
 			int new_draw;
@@ -127,7 +154,7 @@ namespace GPBoost {
 			else {
 				new_draw = r;
 			}
-			if (std::find(exclude.begin(), exclude.end(), new_draw) == exclude.end()) {
+			if (!std::binary_search(exclude_sorted.begin(), exclude_sorted.end(), new_draw)) {
 				indices.push_back(new_draw);
 			}
 			else {
@@ -154,9 +154,15 @@ namespace GPBoost {
 		double radius,
 		const vec_t& mid,
 		std::vector<int>& indices) {
-		for (int i = 0; i < (int)indices_start.size(); ++i) {
-			double distance = (data(indices_start[i], Eigen::all) - (den_mat_t)mid.transpose()).lpNorm<2>();
-			if (distance <= radius) {
+		int num_indices = (int)indices_start.size();
+		//gather the candidate coordinates into a contiguous matrix and calculate all distances in one vectorized expression
+		den_mat_t data_gathered(num_indices, data.cols());
+		for (int i = 0; i < num_indices; ++i) {
+			data_gathered.row(i) = data.row(indices_start[i]);
+		}
+		vec_t distances = (data_gathered.rowwise() - mid.transpose()).rowwise().norm();
+		for (int i = 0; i < num_indices; ++i) {
+			if (distances[i] <= radius) {
 				indices.push_back(indices_start[i]);
 			}
 		}
@@ -184,20 +190,19 @@ namespace GPBoost {
 		//number of nodes
 		int M_l_minus = 1;
 		//radius
-		double R_max = pow(2, L) * eps;
+		double R_max = std::ldexp(eps, L);//eps * 2^L
 		//Initialization
 		int M_l, c;
-		double R_l;
+		double R_l = R_max;
 		std::vector<int> all_indices(data.rows());
 		std::iota(std::begin(all_indices), std::end(all_indices), 0);
-		// Covert points
-		std::map<int, std::vector<int>> covert_points_old;
-		covert_points_old[0] = all_indices;
-		std::map<int, std::vector<int>> covert_points;
+		// Covert points (node-indexed contiguous containers, resized per level)
+		std::vector<std::vector<int>> covert_points_old;
+		std::vector<std::vector<int>> covert_points(1);
 		covert_points[0] = all_indices;
-		std::map<int, std::vector<int>> children;
-		std::map<int, std::vector<int>> R_neighbors;
-		R_neighbors[0].push_back(0);
+		// R_neighbors in flat CSR layout: the neighbors of node p are R_neighbors_flat[R_neighbors_offsets[p]:R_neighbors_offsets[p+1]]
+		std::vector<int> R_neighbors_flat{ 0 };
+		std::vector<int> R_neighbors_offsets{ 0, 1 };
 		means.resize(data.rows(), data.cols());
 		int count_ip = 0;
 		for (int l = 0; l < L; ++l) {
@@ -207,17 +212,13 @@ namespace GPBoost {
 			M_l = 0;
 			//child node index
 			c = 0;
-			//new radius
-			R_l = R_max / pow(2, l + 1);
-			children.clear();
-			covert_points_old.clear();
-			covert_points_old = covert_points;
+			//new radius (halved every level, R_l = R_max / 2^(l+1))
+			R_l = 0.5 * R_l;
+			covert_points_old.swap(covert_points);
 			covert_points.clear();
-			
+
 			for (int p = 0; p < M_l_minus; ++p) {
-				children[p].clear();
-				
-				
+				int first_child_p = c;//children of parent p are the consecutive node indices first_child_p, ..., c - 1
 				do {
 					if ((int)covert_points_old[p].size() == 0) {
 						break;
@@ -229,10 +230,10 @@ namespace GPBoost {
 					
 					std::vector<int> intersection_vect = indices_ball;
 					den_mat_t zeta_opt = data(intersection_vect, Eigen::all).colwise().mean();
-					vec_t distance_to_others(children[p].size());
+					vec_t distance_to_others(c - first_child_p);
 #pragma omp parallel for schedule(static)
-					for (int i = 0; i < (int)children[p].size(); ++i) {
-						distance_to_others[i] = (means(children[p][i], Eigen::all) - zeta_opt).lpNorm<2>();
+					for (int i = 0; i < (c - first_child_p); ++i) {
+						distance_to_others[i] = (means(first_child_p + i, Eigen::all) - zeta_opt).lpNorm<2>();
 
 					}
 					if (distance_to_others.size() > 0) {
@@ -245,26 +246,28 @@ namespace GPBoost {
 					}
 					
 					// Remove Covert indices
-					for (int ii = 0; ii < (int)R_neighbors[p].size(); ++ii) {
-						int index_R_neighbors = R_neighbors[p][ii];
-						std::vector<int> indices_ball_c;
-						data_in_ball(data, covert_points_old[index_R_neighbors], R_l, means(c, Eigen::all), indices_ball_c);
-						std::vector<int> diff_vect;
-						std::set_difference(covert_points_old[index_R_neighbors].begin(), covert_points_old[index_R_neighbors].end(),
-							indices_ball_c.begin(), indices_ball_c.end(),
-							std::inserter(diff_vect, diff_vect.begin()));
-						covert_points_old[index_R_neighbors] = diff_vect;
+					//	every R-neighbor is a distinct node index, so the iterations update disjoint entries of covert_points_old and can run in parallel
+#pragma omp parallel for schedule(dynamic)
+					for (int ii = R_neighbors_offsets[p]; ii < R_neighbors_offsets[p + 1]; ++ii) {
+						int index_R_neighbors = R_neighbors_flat[ii];
+						std::vector<int>& covert_points_old_i = covert_points_old[index_R_neighbors];
+						int num_indices = (int)covert_points_old_i.size();
+						//calculate all distances to the new node in one vectorized expression (as in data_in_ball) and
+						//	keep the uncovered points (distance > R_l) in place in a single compaction pass without intermediate index vectors
+						den_mat_t data_gathered(num_indices, data.cols());
+						for (int i = 0; i < num_indices; ++i) {
+							data_gathered.row(i) = data.row(covert_points_old_i[i]);
+						}
+						vec_t distances = (data_gathered.rowwise() - means.row(c)).rowwise().norm();
+						int ind_write = 0;
+						for (int i = 0; i < num_indices; ++i) {
+							if (distances[i] > R_l) {
+								covert_points_old_i[ind_write++] = covert_points_old_i[i];
+							}
+						}
+						covert_points_old_i.resize(ind_write);
 					}
 
-					
-					if (children.find(p) == children.end()) {
-						std::vector<int> id_c{ c };
-						children.insert({ p, id_c });
-					}
-					else {
-						children[p].push_back(c);
-					}
-					
 					c += 1;
 					count_ip += 1;
 					M_l += 1;
@@ -273,31 +276,35 @@ namespace GPBoost {
 			}
 			// Voroni
 			den_mat_t means_c = means.topRows(c + 1);
+			covert_points.assign(means_c.rows(), std::vector<int>());
 			for (int ii = 0; ii < data.rows(); ++ii) {
 				int i = 0;
-				vec_t distances_jj(means_c.rows());
-#pragma omp parallel for schedule(static)
-				for (int jj = 0; jj < means_c.rows(); ++jj) {
-					distances_jj[jj] = (means_c(jj, Eigen::all) - data(ii, Eigen::all)).lpNorm<2>();
-				}
-				if (covert_points.find(i) == covert_points.end()) {
-					std::vector<int> id_min_c{ ii };
-					covert_points.insert({ i, id_min_c });
-				}
-				else {
-					covert_points[i].push_back(ii);
-				}
+				//distances of point ii to all current nodes in one batched expression instead of an OpenMP region per point
+				vec_t distances_jj = (means_c.rowwise() - data.row(ii)).rowwise().norm();
+				covert_points[i].push_back(ii);
 			}
-			R_neighbors.clear();
 			// R_neighbors
-			for (int jj = 0; jj < means_c.rows(); ++jj) {
-				for (int ii = 0; ii < means_c.rows(); ++ii) {
+			double R_neighbors_radius = 4 * (1 - 1 / std::ldexp(1.0, L - l)) * R_l;//level-wise constant, hoisted out of the pairwise loop
+			//exploit symmetry: every unordered pair is evaluated only once and inserted into both adjacency lists
+			//	(processing jj in increasing order keeps every list sorted in increasing order as before)
+			int num_nodes = (int)means_c.rows();
+			std::vector<std::vector<int>> R_neighbors_lists(num_nodes);
+			for (int jj = 0; jj < num_nodes; ++jj) {
+				R_neighbors_lists[jj].push_back(jj);//distance zero to itself
+				for (int ii = jj + 1; ii < num_nodes; ++ii) {
 					double distance_btw_childs = (means_c(jj, Eigen::all) - means_c(ii, Eigen::all)).lpNorm<2>();
-					if (distance_btw_childs <= 4 * (1 - 1 / pow(2, L - l)) * R_l) {
-						R_neighbors[jj].push_back(ii);
+					if (distance_btw_childs <= R_neighbors_radius) {
+						R_neighbors_lists[jj].push_back(ii);
+						R_neighbors_lists[ii].push_back(jj);
 					}
 				}
 			}
+			R_neighbors_flat.clear();
+			R_neighbors_offsets.assign(1, 0);
+			for (int jj = 0; jj < num_nodes; ++jj) {
+				R_neighbors_flat.insert(R_neighbors_flat.end(), R_neighbors_lists[jj].begin(), R_neighbors_lists[jj].end());
+				R_neighbors_offsets.push_back((int)R_neighbors_flat.size());
+			}
 			M_l_minus = M_l;
 		}
 		means.conservativeResize(count_ip, means.cols());
@@ -21,6 +21,8 @@ namespace GPBoost {
 		std::vector<std::vector<int>>& neighbors) {
 		CHECK((int)neighbors.size() == num_data);
 		CHECK((int)dist.rows() == num_data && (int)dist.cols() == num_data);
+		//iterations write to disjoint neighbors[i] and can be initialized in parallel
+#pragma omp parallel for schedule(static)
 		for (int i = 0; i < num_data; ++i) {
 			if (i > 0 && i <= num_neighbors) {
 				neighbors[i].resize(i);
@@ -35,22 +37,98 @@ namespace GPBoost {
 		if (num_data > num_neighbors) {
 #pragma omp parallel for schedule(static)
 			for (int i = (num_neighbors + 1); i < num_data; ++i) {
-				std::vector<double> nn_dist(num_neighbors);
-				for (int j = 0; j < num_neighbors; ++j) {
-					nn_dist[j] = std::numeric_limits<double>::infinity();
-				}
+				//online top-k via a max-heap keyed on (distance, index): O(log num_neighbors) per accepted candidate
+				//	candidates are scanned in increasing index order, so sorting the heap by (distance, index) at the end
+				//	reproduces exactly the neighbor order of the former insertion-sort based search (also for tied distances)
+				std::vector<std::pair<double, int>> nn_heap(num_neighbors, { std::numeric_limits<double>::infinity(), -1 });
 				for (int j = 0; j < i; ++j) {
-					if (dist(i, j) < nn_dist[num_neighbors - 1]) {
-						nn_dist[num_neighbors - 1] = dist(i, j);
-						neighbors[i][num_neighbors - 1] = j;
-						SortVectorsDecreasing<double>(nn_dist.data(), neighbors[i].data(), num_neighbors);
+					double dij = dist(j, i);//the distance matrix is symmetric and column-major, so scanning column i reads contiguous memory (row i would be strided)
+					if (dij < nn_heap.front().first) {
+						std::pop_heap(nn_heap.begin(), nn_heap.end());
+						nn_heap.back() = { dij, j };
+						std::push_heap(nn_heap.begin(), nn_heap.end());
 					}
 				}
+				std::sort(nn_heap.begin(), nn_heap.end());
+				for (int j = 0; j < num_neighbors; ++j) {
+					neighbors[i][j] = nn_heap[j].second;
+				}
 			}
 		}
 	}//end find_nearest_neighbors_Vecchia
 
-	void find_nearest_neighbors_Vecchia_fast(const den_mat_t& coords, 
+	/*! \brief Squared Euclidean distance between rows i and j of coords_rm (row-major, so every point is contiguous in memory), specialized for the low dimensions that dominate in spatial applications */
+	static inline double SquaredDistanceRows(const den_mat_rm_t& coords_rm, int dim_coords, int i, int j) {
+		const double* xi = coords_rm.data() + (size_t)i * dim_coords;
+		const double* xj = coords_rm.data() + (size_t)j * dim_coords;
+		if (dim_coords == 2) {
+			double d0 = xj[0] - xi[0];
+			double d1 = xj[1] - xi[1];
+			return d0 * d0 + d1 * d1;
+		}
+		else if (dim_coords == 3) {
+			double d0 = xj[0] - xi[0];
+			double d1 = xj[1] - xi[1];
+			double d2 = xj[2] - xi[2];
+			return d0 * d0 + d1 * d1 + d2 * d2;
+		}
+		else if (dim_coords == 1) {
+			double d0 = xj[0] - xi[0];
+			return d0 * d0;
+		}
+		double sq_dist = 0.;
+		for (int k = 0; k < dim_coords; ++k) {
+			double dk = xj[k] - xi[k];
+			sq_dist += dk * dk;
+		}
+		return sq_dist;
+	}//end SquaredDistanceRows
+
+	/*! \brief Calculates the distances among the neighbors of one point and checks for duplicates (auxiliary function for find_nearest_neighbors_Vecchia_fast) */
+	static void CalcDistancesBetweenNeighbors(const den_mat_rm_t& coords_rm,
+		int dim_coords,
+		const std::vector<int>& neighbors_i,
+		int ind,
+		bool save_distances,
+		bool check_has_duplicates,
+		bool& has_duplicates,
+		std::vector<den_mat_t>& dist_between_neighbors) {
+		int nn_i = (int)neighbors_i.size();
+		if (save_distances) {
+			dist_between_neighbors[ind].resize(nn_i, nn_i);
+		}
+		if (save_distances || (check_has_duplicates && !has_duplicates)) {
+			//gather the neighbor coordinates once into a contiguous matrix so that the distances of
+			//	every neighbor to all subsequent neighbors can be calculated in one vectorized expression
+			//	(gathered from the row-major copy where every point is one contiguous read)
+			den_mat_t coords_nn(nn_i, dim_coords);
+			for (int j = 0; j < nn_i; ++j) {
+				coords_nn.row(j) = coords_rm.row(neighbors_i[j]);
+			}
+			for (int j = 0; j < nn_i; ++j) {
+				if (save_distances) {
+					dist_between_neighbors[ind](j, j) = 0.;
+				}
+				if (j < (nn_i - 1)) {
+					vec_t dist_j = (coords_nn.bottomRows(nn_i - j - 1).rowwise() - coords_nn.row(j)).rowwise().norm();
+					if (save_distances) {
+						dist_between_neighbors[ind].row(j).tail(nn_i - j - 1) = dist_j.transpose();
+					}
+					if (check_has_duplicates && !has_duplicates) {
+						if (dist_j.minCoeff() < EPSILON_NUMBERS) {
+#pragma omp atomic write
+							has_duplicates = true;
+						}
+					}//end check_has_duplicates
+				}
+			}
+		}
+		if (save_distances) {
+			dist_between_neighbors[ind].triangularView<Eigen::StrictlyLower>() = dist_between_neighbors[ind].triangularView<Eigen::StrictlyUpper>().transpose();
+		}
+	}//end CalcDistancesBetweenNeighbors
+
+	void find_nearest_neighbors_Vecchia_fast(const den_mat_t& coords,
 		int num_data, 
 		int num_neighbors,
 		std::vector<std::vector<int>>& neighbors, 
@@ -79,7 +157,10 @@ namespace GPBoost {
 		int num_non_nearest_neighbors = 0;
 		int mult_const_half_random_close_neighbors = 10;//amount of neighbors that are considered as candidate non-nearest but still close neighbors
 		int num_close_neighbors = mult_const_half_random_close_neighbors * num_neighbors;
-		if (neighbor_selection == "half_random" || neighbor_selection == "half_random_close_neighbors") {
+		//evaluate the neighbor selection strategy once here instead of comparing strings for every point in the hot loop below
+		const bool nb_sel_half_random = (neighbor_selection == "half_random");
+		const bool nb_sel_half_random_close = (neighbor_selection == "half_random_close_neighbors");
+		if (nb_sel_half_random || nb_sel_half_random_close) {
 			num_non_nearest_neighbors = num_neighbors / 2;
 			num_nearest_neighbors = num_neighbors - num_non_nearest_neighbors;
 			CHECK(num_non_nearest_neighbors > 0);
@@ -89,12 +170,15 @@ namespace GPBoost {
 		}
 		bool has_duplicates = false;
 		int dim_coords = (int)coords.cols();
-		//Sort along the sum of the coordinates
-		std::vector<double> coords_sum(num_data);
+		//row-major copy of the coordinates so that every point is contiguous in memory for the distance kernel of the nearest neighbor search
+		den_mat_rm_t coords_rm(num_data, dim_coords);
 #pragma omp parallel for schedule(static)
 		for (int i = 0; i < num_data; ++i) {
-			coords_sum[i] = coords(i, Eigen::all).sum();
+			coords_rm.row(i) = coords.row(i);
 		}
+		//Sort along the sum of the coordinates
+		std::vector<double> coords_sum(num_data);
+		Eigen::Map<vec_t>(coords_sum.data(), num_data) = coords.rowwise().sum();
 		std::vector<int> sort_sum(num_data);
 		SortIndeces<double>(coords_sum, sort_sum);
 		std::vector<int> sort_inv_sum(num_data);
@@ -102,28 +186,29 @@ namespace GPBoost {
 		for (int i = 0; i < num_data; ++i) {
 			sort_inv_sum[sort_sum[i]] = i;
 		}
-		//Intialize neighbor vectors
+		//Intialize neighbor vectors (iterations write to disjoint output slots and can be run in parallel)
+#pragma omp parallel for schedule(static)
 		for (int i = start_at; i < num_data; ++i) {
 			if (i > 0 && i <= num_neighbors) {
 				neighbors[i - start_at].resize(i);
-				if (save_distances) {
-					dist_obs_neighbors[i - start_at].resize(i, 1);
-				}
 				for (int j = 0; j < i; ++j) {
 					neighbors[i - start_at][j] = j;
-					double dij = 0.;
-					if (save_distances || (check_has_duplicates && !has_duplicates)) {
-						dij = (coords(j, Eigen::all) - coords(i, Eigen::all)).lpNorm<2>();
-					}
+				}
+				if (save_distances || (check_has_duplicates && !has_duplicates)) {
+					//calculate the distances of point i to all previous points in one vectorized expression
+					vec_t dist_i = (coords.topRows(i).rowwise() - coords.row(i)).rowwise().norm();
 					if (save_distances) {
-						dist_obs_neighbors[i - start_at](j, 0) = dij;
+						dist_obs_neighbors[i - start_at] = dist_i;
 					}
 					if (check_has_duplicates && !has_duplicates) {
-						if (dij < EPSILON_NUMBERS) {
+						if (dist_i.minCoeff() < EPSILON_NUMBERS) {
+#pragma omp atomic write
 							has_duplicates = true;
 						}
 					}//end check_has_duplicates
 				}
+				CalcDistancesBetweenNeighbors(coords_rm, dim_coords, neighbors[i - start_at], i - start_at,
+					save_distances, check_has_duplicates, has_duplicates, dist_between_neighbors);
 			}
 			else if (i > num_neighbors) {
 				neighbors[i - start_at].resize(num_neighbors);
@@ -132,109 +217,84 @@ namespace GPBoost {
 		//Find neighbors for those points where the conditioning set (=candidate neighbors) is larger than 'num_neighbors'
 		if (num_data > num_neighbors) {
 			int first_i = (start_at <= num_neighbors) ? (num_neighbors + 1) : start_at;//The first point (first_i) for which the search is done is the point with index (num_neighbors + 1) or start_at
-#pragma omp parallel for schedule(static)
-			for (int i = first_i; i < num_data; ++i) {
-				int num_cand_neighbors = std::min<int>({ i, end_search_at + 1 });
+#pragma omp parallel
+			{
+				//buffers reused across the iterations of each thread instead of being reallocated for every point
 				std::vector<int> neighbors_i;
 				std::vector<double> nn_square_dist;
-				if (neighbor_selection == "half_random_close_neighbors" && num_cand_neighbors > num_close_neighbors) {
-					neighbors_i.resize(num_close_neighbors);
-					find_nearest_neighbors_fast_internal(i, num_data, num_close_neighbors, end_search_at,
-						dim_coords, coords, sort_sum, sort_inv_sum, coords_sum, neighbors_i, nn_square_dist);
-					std::copy(neighbors_i.begin(), neighbors_i.begin() + num_nearest_neighbors, neighbors[i - start_at].begin());
-				}
-				else {
-					find_nearest_neighbors_fast_internal(i, num_data, num_nearest_neighbors, end_search_at,
-						dim_coords, coords, sort_sum, sort_inv_sum, coords_sum, neighbors[i - start_at], nn_square_dist);
-				}
-				//Save distances between points and neighbors
-				if (save_distances) {
-					dist_obs_neighbors[i - start_at].resize(num_neighbors, 1);
-				}
-				for (int j = 0; j < num_nearest_neighbors; ++j) {
-					double dij = std::sqrt(nn_square_dist[j]);
+				//dynamic scheduling since the work per point varies considerably (the search extent depends on how fast the pruning threshold shrinks)
+#pragma omp for schedule(dynamic)
+				for (int i = first_i; i < num_data; ++i) {
+					int num_cand_neighbors = std::min<int>({ i, end_search_at + 1 });
+					//hoist the per-point neighbor list that is indexed repeatedly below
+					std::vector<int>& neighbors_point_i = neighbors[i - start_at];
+					if (nb_sel_half_random_close && num_cand_neighbors > num_close_neighbors) {
+						neighbors_i.resize(num_close_neighbors);
+						find_nearest_neighbors_fast_internal(i, num_data, num_close_neighbors, end_search_at,
+							dim_coords, coords_rm, sort_sum, sort_inv_sum, coords_sum, neighbors_i, nn_square_dist);
+						std::copy(neighbors_i.begin(), neighbors_i.begin() + num_nearest_neighbors, neighbors_point_i.begin());
+					}
+					else {
+						find_nearest_neighbors_fast_internal(i, num_data, num_nearest_neighbors, end_search_at,
+							dim_coords, coords_rm, sort_sum, sort_inv_sum, coords_sum, neighbors_point_i, nn_square_dist);
+					}
+					//Save distances between points and neighbors (the squared distances from the search are reused, nothing is recomputed)
 					if (save_distances) {
-						dist_obs_neighbors[i - start_at](j, 0) = dij;
+						dist_obs_neighbors[i - start_at].resize(num_neighbors, 1);
 					}
-					if (check_has_duplicates && !has_duplicates) {
-						if (dij < EPSILON_NUMBERS) {
-#pragma omp critical
-							{
-								has_duplicates = true;
+					if (save_distances || (check_has_duplicates && !has_duplicates)) {
+						for (int j = 0; j < num_nearest_neighbors; ++j) {
+							double dij = std::sqrt(nn_square_dist[j]);
+							if (save_distances) {
+								dist_obs_neighbors[i - start_at](j, 0) = dij;
 							}
-						}
-					}//end check_has_duplicates
-				}
-				//Find non-nearest neighbors
-				if (neighbor_selection == "half_random" || neighbor_selection == "half_random_close_neighbors") {
-					if (neighbor_selection == "half_random" ||
-						(neighbor_selection == "half_random_close_neighbors" && num_cand_neighbors <= num_close_neighbors)) {
-						std::vector<int> nearest_neighbors(neighbors[i - start_at].begin(), neighbors[i - start_at].begin() + num_nearest_neighbors);
-						std::vector<int> non_nearest_neighbors;
-						SampleIntNoReplaceExcludeSomeIndices(num_cand_neighbors, num_non_nearest_neighbors, gen, non_nearest_neighbors, nearest_neighbors);
-						std::copy(non_nearest_neighbors.begin(), non_nearest_neighbors.end(), neighbors[i - start_at].begin() + num_nearest_neighbors);
-					}
-					else if (neighbor_selection == "half_random_close_neighbors" && num_cand_neighbors > num_close_neighbors){
-						std::vector<int> ind_non_nearest_neighbors;
-						SampleIntNoReplace(num_close_neighbors - num_nearest_neighbors, num_non_nearest_neighbors, gen, ind_non_nearest_neighbors);
-						for (int j = 0; j < num_non_nearest_neighbors; ++j) {
-							neighbors[i - start_at][num_nearest_neighbors + j] = neighbors_i[ind_non_nearest_neighbors[j] + num_nearest_neighbors];
+							if (check_has_duplicates && !has_duplicates) {
+								if (dij < EPSILON_NUMBERS) {
+#pragma omp atomic write
+									has_duplicates = true;
+								}
+							}//end check_has_duplicates
 						}
 					}
-					//Calculate distances between points and neighbors
-					for (int j = 0; j < num_non_nearest_neighbors; ++j) {
-						double dij = 0.;
-						if (save_distances || (check_has_duplicates && !has_duplicates)) {
-							dij = (coords(neighbors[i - start_at][num_nearest_neighbors + j], Eigen::all) - coords(i, Eigen::all)).norm();
+					//Find non-nearest neighbors
+					if (nb_sel_half_random || nb_sel_half_random_close) {
+						if (nb_sel_half_random ||
+							(nb_sel_half_random_close && num_cand_neighbors <= num_close_neighbors)) {
+							std::vector<int> non_nearest_neighbors;
+							SampleIntNoReplaceExcludeSomeIndices(num_cand_neighbors, num_non_nearest_neighbors, gen, non_nearest_neighbors, neighbors_point_i, num_nearest_neighbors);
+							std::copy(non_nearest_neighbors.begin(), non_nearest_neighbors.end(), neighbors_point_i.begin() + num_nearest_neighbors);
 						}
-						if (save_distances) {
-							dist_obs_neighbors[i - start_at](num_nearest_neighbors + j, 0) = dij;
+						else if (nb_sel_half_random_close && num_cand_neighbors > num_close_neighbors){
+							std::vector<int> ind_non_nearest_neighbors;
+							SampleIntNoReplace(num_close_neighbors - num_nearest_neighbors, num_non_nearest_neighbors, gen, ind_non_nearest_neighbors);
+							for (int j = 0; j < num_non_nearest_neighbors; ++j) {
+								neighbors_point_i[num_nearest_neighbors + j] = neighbors_i[ind_non_nearest_neighbors[j] + num_nearest_neighbors];
+							}
 						}
-						if (check_has_duplicates && !has_duplicates) {
-							if (dij < EPSILON_NUMBERS) {
-#pragma omp critical
-								{
-									has_duplicates = true;
-								}
+						//Calculate distances between points and neighbors
+						if (save_distances || (check_has_duplicates && !has_duplicates)) {
+							//gather the sampled neighbors into a contiguous matrix and calculate all distances in one vectorized expression
+							den_mat_t coords_nn(num_non_nearest_neighbors, dim_coords);
+							for (int j = 0; j < num_non_nearest_neighbors; ++j) {
+								coords_nn.row(j) = coords_rm.row(neighbors_point_i[num_nearest_neighbors + j]);
 							}
-						}//end check_has_duplicates
-					}
-				}//end selection of non-nearest neighbors
-			}//end parallel for loop for finding neighbors
-		}
-		// Calculate distances among neighbors
-		int first_i = (start_at == 0) ? 1 : start_at;
-#pragma omp parallel for schedule(static)
-		for (int i = first_i; i < num_data; ++i) {
-			int nn_i = (int)neighbors[i - start_at].size();
-			if (save_distances) {
-				dist_between_neighbors[i - start_at].resize(nn_i, nn_i);
-			}
-			for (int j = 0; j < nn_i; ++j) {
-				if (save_distances) {
-					dist_between_neighbors[i - start_at](j, j) = 0.;
-				}
-				for (int k = j + 1; k < nn_i; ++k) {
-					double dij = 0.;
-					if (save_distances || (check_has_duplicates && !has_duplicates)) {
-						dij = (coords(neighbors[i - start_at][j], Eigen::all) - coords(neighbors[i - start_at][k], Eigen::all)).lpNorm<2>();
-					}
-					if (save_distances) {
-						dist_between_neighbors[i - start_at](j, k) = dij;
-					}
-					if (check_has_duplicates && !has_duplicates) {
-						if (dij < EPSILON_NUMBERS) {
-#pragma omp critical
-							{
-								has_duplicates = true;
+							vec_t dist_nn = (coords_nn.rowwise() - coords.row(i)).rowwise().norm();
+							if (save_distances) {
+								dist_obs_neighbors[i - start_at].col(0).tail(num_non_nearest_neighbors) = dist_nn;
 							}
+							if (check_has_duplicates && !has_duplicates) {
+								if (dist_nn.minCoeff() < EPSILON_NUMBERS) {
+#pragma omp atomic write
+									has_duplicates = true;
+								}
+							}//end check_has_duplicates
 						}
-					}//end check_has_duplicates
-				}
-			}
-			if (save_distances) {
-				dist_between_neighbors[i - start_at].triangularView<Eigen::StrictlyLower>() = dist_between_neighbors[i - start_at].triangularView<Eigen::StrictlyUpper>().transpose();
-			}
+					}//end selection of non-nearest neighbors
+					// Calculate distances among neighbors (fused here to avoid a separate pass over all points)
+					CalcDistancesBetweenNeighbors(coords_rm, dim_coords, neighbors_point_i, i - start_at,
+						save_distances, check_has_duplicates, has_duplicates, dist_between_neighbors);
+				}//end parallel for loop for finding neighbors
+			}//end omp parallel
 		}
 		if (check_has_duplicates) {
 			check_has_duplicates = has_duplicates;
@@ -246,16 +306,15 @@ namespace GPBoost {
 		const int num_nearest_neighbors,
 		const int end_search_at,
 		const int dim_coords,
-		const den_mat_t& coords,
+		const den_mat_rm_t& coords_rm,
 		const std::vector<int>& sort_sum,
 		const std::vector<int>& sort_inv_sum,
 		const std::vector<double>& coords_sum,
 		std::vector<int>& neighbors_i,
 		std::vector<double>& nn_square_dist) {
-		nn_square_dist = std::vector<double>(num_nearest_neighbors);
-		for (int j = 0; j < num_nearest_neighbors; ++j) {
-			nn_square_dist[j] = std::numeric_limits<double>::infinity();
-		}
+		nn_square_dist.assign(num_nearest_neighbors, std::numeric_limits<double>::infinity());//assign() reuses the capacity of the caller's buffer
+		double nn_dist_worst = std::numeric_limits<double>::infinity();//current k-th smallest squared distance, kept in a register
+		const double coords_sum_i = coords_sum[i];//loaded once instead of in every pruning test
 		bool down = true;
 		bool up = true;
 		int up_i = sort_inv_sum[i];
@@ -271,17 +330,18 @@ namespace GPBoost {
 			if (down) {
 				down_i--;
 				//counting is done on the sorted scale, but the index on the orignal scale needs to be (i) smaller than 'i' in order to be a neighbor (ii) and also below or equal the largest potential neighbor 'end_search_at'
-				if (sort_sum[down_i] < i && sort_sum[down_i] <= end_search_at) {
-					smd = std::pow(coords_sum[sort_sum[down_i]] - coords_sum[i], 2);
-					if (smd > dim_coords * nn_square_dist[num_nearest_neighbors - 1]) {
+				int cand = sort_sum[down_i];
+				if (cand < i && cand <= end_search_at) {
+					double d_sum = coords_sum[cand] - coords_sum_i;
+					smd = d_sum * d_sum;
+					if (smd > dim_coords * nn_dist_worst) {
 						down = false;
 					}
 					else {
-						sed = (coords(sort_sum[down_i], Eigen::all) - coords(i, Eigen::all)).squaredNorm();
-						if (sed < nn_square_dist[num_nearest_neighbors - 1]) {
-							nn_square_dist[num_nearest_neighbors - 1] = sed;
-							neighbors_i[num_nearest_neighbors - 1] = sort_sum[down_i];
-							SortVectorsDecreasing<double>(nn_square_dist.data(), neighbors_i.data(), num_nearest_neighbors);
+						sed = SquaredDistanceRows(coords_rm, dim_coords, i, cand);
+						if (sed < nn_dist_worst) {
+							InsertNeighborSorted<double>(nn_square_dist.data(), neighbors_i.data(), num_nearest_neighbors, sed, cand);
+							nn_dist_worst = nn_square_dist[num_nearest_neighbors - 1];
 						}
 					}
 				}
@@ -289,17 +349,18 @@ namespace GPBoost {
 			if (up) {
 				up_i++;
 				//counting is done on the sorted scale, but the index on the orignal scale needs to be (i) smaller than 'i' in order to be a neighbor (ii) and also below or equal the largest potential neighbor 'end_search_at'
-				if (sort_sum[up_i] < i && sort_sum[up_i] <= end_search_at) {
-					smd = std::pow(coords_sum[sort_sum[up_i]] - coords_sum[i], 2);
-					if (smd > dim_coords * nn_square_dist[num_nearest_neighbors - 1]) {
+				int cand = sort_sum[up_i];
+				if (cand < i && cand <= end_search_at) {
+					double d_sum = coords_sum[cand] - coords_sum_i;
+					smd = d_sum * d_sum;
+					if (smd > dim_coords * nn_dist_worst) {
 						up = false;
 					}
 					else {
-						sed = (coords(sort_sum[up_i], Eigen::all) - coords(i, Eigen::all)).squaredNorm();
-						if (sed < nn_square_dist[num_nearest_neighbors - 1]) {
-							nn_square_dist[num_nearest_neighbors - 1] = sed;
-							neighbors_i[num_nearest_neighbors - 1] = sort_sum[up_i];
-							SortVectorsDecreasing<double>(nn_square_dist.data(), neighbors_i.data(), num_nearest_neighbors);
+						sed = SquaredDistanceRows(coords_rm, dim_coords, i, cand);
+						if (sed < nn_dist_worst) {
+							InsertNeighborSorted<double>(nn_square_dist.data(), neighbors_i.data(), num_nearest_neighbors, sed, cand);
+							nn_dist_worst = nn_square_dist[num_nearest_neighbors - 1];
 						}
 					}
 				}